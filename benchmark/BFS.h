@@ -63,3 +63,76 @@ inline sequence<uintE> BFS(graph<vertex<W> >& GA, uintE src) {
   std::cout << "Reachable: " << reachable << "\n";
   return Parents;
 }
+
+// Visits vertices from one side of a bidirectional search. Dist holds the
+// levels of the side being expanded and Other the levels of the opposite
+// side. When a newly visited vertex was already reached by the other side,
+// the length of the path through it is a candidate for the s-t distance.
+struct BiBFS_F {
+  uintE* Dist;
+  uintE* Other;
+  uintE* Best;
+  BiBFS_F(uintE* _Dist, uintE* _Other, uintE* _Best)
+      : Dist(_Dist), Other(_Other), Best(_Best) {}
+  inline void meet(const uintE& d) {
+    if (Other[d] != UINT_E_MAX) {
+      pbbslib::write_min(Best, Dist[d] + Other[d]);
+    }
+  }
+  template <class W>
+  inline bool update(const uintE& s, const uintE& d, const W& w) {
+    if (Dist[d] == UINT_E_MAX) {
+      Dist[d] = Dist[s] + 1;
+      meet(d);
+      return 1;
+    } else {
+      return 0;
+    }
+  }
+  template <class W>
+  inline bool updateAtomic(const uintE& s, const uintE& d, const W& w) {
+    if (pbbslib::atomic_compare_and_swap(&Dist[d], UINT_E_MAX, Dist[s] + 1)) {
+      meet(d);
+      return 1;
+    }
+    return 0;
+  }
+  inline bool cond(const uintE& d) { return (Dist[d] == UINT_E_MAX); }
+};
+
+// Computes the unweighted distance from src to dst (UINT_E_MAX if dst is not
+// reachable) with a bidirectional BFS. Each round expands the smaller of the
+// two frontiers; the backward search follows in-edges. The search stops after
+// the first round in which the two searches meet, since the shortest meeting
+// point must have been discovered in that round.
+template <class vertex>
+inline uintE BFS_st(graph<vertex>& GA, uintE src, uintE dst) {
+  if (src == dst) return 0;
+  size_t n = GA.n;
+  auto DistS = sequence<uintE>(n, [&](size_t i) { return UINT_E_MAX; });
+  auto DistT = sequence<uintE>(n, [&](size_t i) { return UINT_E_MAX; });
+  DistS[src] = 0;
+  DistT[dst] = 0;
+  uintE best = UINT_E_MAX;
+
+  vertexSubset FrontierS(n, src);
+  vertexSubset FrontierT(n, dst);
+  size_t visited = 2, rounds = 0;
+  while (best == UINT_E_MAX && !FrontierS.isEmpty() && !FrontierT.isEmpty()) {
+    bool forward = FrontierS.size() <= FrontierT.size();
+    vertexSubset& Frontier = forward ? FrontierS : FrontierT;
+    auto f = forward ? BiBFS_F(DistS.begin(), DistT.begin(), &best)
+                     : BiBFS_F(DistT.begin(), DistS.begin(), &best);
+    flags fl = sparse_blocked | dense_parallel;
+    if (!forward) fl |= in_edges;
+    vertexSubset output = edgeMap(GA, Frontier, f, -1, fl);
+    visited += output.size();
+    Frontier.del();
+    Frontier = output;
+    rounds++;
+  }
+  FrontierS.del();
+  FrontierT.del();
+  std::cout << "Rounds: " << rounds << " visited: " << visited << "\n";
+  return best;
+}
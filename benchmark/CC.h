@@ -33,7 +33,7 @@ namespace cc {
 template <template <class W> class vertex, class W>
 inline sequence<uintE> CC_impl(graph<vertex<W>>& GA, double beta,
                                  size_t level, bool pack = false,
-                                 bool permute = false) {
+                                 bool permute = false, bool semisort = false) {
   size_t n = GA.n;
   permute |= (level > 0);
   timer ldd_t;
@@ -51,7 +51,7 @@ inline sequence<uintE> CC_impl(graph<vertex<W>>& GA, double beta,
   timer contract_t;
   contract_t.start();
 
-  auto c_out = contract::contract(GA, clusters, num_clusters);
+  auto c_out = contract::contract(GA, clusters, num_clusters, semisort);
   contract_t.stop();
   debug(contract_t.reportTotal("contract time"););
   // flags maps from clusters -> no-singleton-clusters
@@ -61,7 +61,7 @@ inline sequence<uintE> CC_impl(graph<vertex<W>>& GA, double beta,
 
   if (GC.m == 0) return clusters;
 
-  auto new_labels = CC_impl(GC, beta, level + 1);
+  auto new_labels = CC_impl(GC, beta, level + 1, false, false, semisort);
   par_for(0, n, pbbslib::kSequentialForThreshold, [&] (size_t i) {
     uintE cluster = clusters[i];
     uintE gc_cluster = flags[cluster];
@@ -106,8 +106,8 @@ inline size_t largest_cc(Seq& labels) {
 }
 
 template <class vertex>
-inline sequence<uintE> CC(graph<vertex>& GA, double beta = 0.2, bool pack = false, bool permute = false) {
-  return CC_impl(GA, beta, 0, pack, permute);
+inline sequence<uintE> CC(graph<vertex>& GA, double beta = 0.2, bool pack = false, bool permute = false, bool semisort = false) {
+  return CC_impl(GA, beta, 0, pack, permute, semisort);
 }
 
 }  // namespace cc
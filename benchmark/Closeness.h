@@ -0,0 +1,110 @@
+// This code is part of the project "Theoretically Efficient Parallel Graph
+// Algorithms Can Be Fast and Scalable", presented at Symposium on Parallelism
+// in Algorithms and Architectures, 2018.
+// Copyright (c) 2018 Laxman Dhulipala, Guy Blelloch, and Julian Shun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all  copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Closeness and harmonic centrality. Both are computed from per-vertex
+// accumulators filled by the bit-parallel BFS of Eccentricity.h: when a vertex
+// v is first reached in round r by the sources in a 64-bit mask, every one of
+// them is at distance r from v (to v along in-edges on directed graphs), so v
+// adds r and 1/r per source to its distance sum and harmonic sum. With every
+// vertex as a source the scores are exact; with k random sources they are the
+// sampling estimates of Eppstein and Wang, scaled by n/k.
+
+#pragma once
+
+#include <fstream>
+
+#include "Eccentricity.h"
+#include "ligra.h"
+
+namespace closeness {
+
+struct scores {
+  size_t n;
+  sequence<double> closeness;  // (#reached) / (sum of distances to them)
+  sequence<double> harmonic;   // sum of 1/d over the reached vertices
+
+  scores(size_t _n) : n(_n) {
+    closeness = sequence<double>(n, 0.0);
+    harmonic = sequence<double>(n, 0.0);
+  }
+
+  // Writes n, then the closeness and harmonic scores, as binary.
+  void write(const std::string& fname) const {
+    std::ofstream out(fname, std::ofstream::out | std::ios::binary);
+    if (!out.is_open()) {
+      std::cout << "Unable to open file " << fname << "\n";
+      abort();
+    }
+    uint64_t header[1] = {n};
+    out.write((char*)header, sizeof(header));
+    out.write((char*)closeness.begin(), n * sizeof(double));
+    out.write((char*)harmonic.begin(), n * sizeof(double));
+    out.close();
+  }
+};
+
+}  // namespace closeness
+
+// Computes closeness and harmonic centrality using num_samples random sources,
+// or every vertex if num_samples is 0 or at least n. Scores are over outgoing
+// distances; symmetric should be false for directed graphs.
+template <template <class W> class vertex, class W>
+inline closeness::scores Closeness(graph<vertex<W>>& G, size_t num_samples,
+                                   bool symmetric) {
+  size_t n = G.n;
+  bool exact = (num_samples == 0 || num_samples >= n);
+  size_t k = exact ? n : num_samples;
+  auto r = pbbslib::random();
+  auto source = [&](size_t i) -> uintE {
+    return exact ? i : (r.ith_rand(i) % n);
+  };
+
+  auto dist_sum = sequence<uint64_t>(n, (uint64_t)0);
+  auto reached = sequence<uintE>(n, (uintE)0);
+  auto harmonic = sequence<double>(n, 0.0);
+  auto visit_f = [&](uintE v, uint64_t bits, uintE round) {
+    size_t cnt = __builtin_popcountl(bits);
+    dist_sum[v] += cnt * round;
+    reached[v] += cnt;
+    harmonic[v] += ((double)cnt) / round;
+  };
+  // Distances from v are distances to v in the transpose.
+  flags fl = symmetric ? 0 : in_edges;
+  size_t rd = 0;
+  for (size_t done = 0; done < k; done += eccentricity::kLanes, rd++) {
+    size_t b = std::min(eccentricity::kLanes, k - done);
+    auto batch = sequence<uintE>(b, [&](size_t j) { return source(done + j); });
+    eccentricity::bit_parallel_bfs(G, batch, visit_f, fl);
+  }
+  std::cout << "sources = " << k << " traversals = " << rd << "\n";
+
+  auto S = closeness::scores(n);
+  double scale = ((double)n) / k;
+  par_for(0, n, pbbslib::kSequentialForThreshold, [&] (size_t v) {
+    if (dist_sum[v] > 0) {
+      S.closeness[v] = ((double)reached[v]) / dist_sum[v];
+    }
+    S.harmonic[v] = harmonic[v] * scale;
+  });
+  return S;
+}
@@ -58,6 +58,135 @@ inline uintE color(graph<vertex<W>>& GA, uintE v, Seq& colors) {
   }
   return 0;
 }
+
+// The LLF order: a vertex with larger log-degree is colored first, and ties
+// are broken by a random permutation.
+inline bool llf_before(uintE u_deg, uintE u_p, uintE v_deg, uintE v_p) {
+  return (u_deg > v_deg) || ((u_deg == v_deg) && u_p < v_p);
+}
+
+// Per-worker bitsets of forbidden colors, grown on demand.
+struct color_bitsets {
+  size_t nw;
+  sequence<uint64_t>* bits;
+  color_bitsets() : nw(num_workers()) { bits = new sequence<uint64_t>[nw]; }
+  ~color_bitsets() { delete[] bits; }
+
+  // Returns a cleared bitset with at least words 64-bit words.
+  uint64_t* get(size_t words) {
+    auto& b = bits[worker_id()];
+    if (b.size() < words) {
+      b = sequence<uint64_t>(2 * words);
+    }
+    for (size_t i = 0; i < words; i++) b[i] = 0;
+    return b.begin();
+  }
+};
+
+// Same as color, but the neighborhood is scanned sequentially into the
+// calling worker's bitset. Only colors in [0, deg] can be the answer, so the
+// bitset needs deg / 64 + 1 words.
+template <template <typename W> class vertex, class W, class Seq>
+inline uintE color_bits(graph<vertex<W>>& GA, uintE v, Seq& colors,
+                        color_bitsets& bitsets) {
+  uintE deg = GA.V[v].getOutDegree();
+  if (deg == 0) return 0;
+  size_t words = deg / 64 + 1;
+  uint64_t* bits = bitsets.get(words);
+  auto map_f = [&](const uintE& src, const uintE& ngh, const W& wgh) {
+    uintE color = colors[ngh];
+    if (color <= deg) {
+      bits[color >> 6] |= ((uint64_t)1) << (color & 63);
+    }
+  };
+  GA.V[v].mapOutNgh(v, map_f, false);
+  for (size_t i = 0; i < words; i++) {
+    if (~bits[i]) return (i << 6) + __builtin_ctzll(~bits[i]);
+  }
+  return deg;  // unreachable: at most deg colors are forbidden
+}
+
+// Applies f(w) to every vertex w != v reachable from v by a two-hop path
+// v - u - w, and also to the neighbors of v unless partial is set. With
+// partial set, the first hop follows in-edges, so w ranges over the vertices
+// that share an in-neighbor with v. Vertices are visited once per path.
+template <template <typename W> class vertex, class W, class F>
+inline void map_two_hop(graph<vertex<W>>& GA, uintE v, bool partial, F& f,
+                        bool parallel = true) {
+  auto second_f = [&](const uintE& u, const uintE& w, const W& wgh) {
+    if (w != v) f(w);
+  };
+  auto first_f = [&](const uintE& src, const uintE& u, const W& wgh) {
+    if (!partial) f(u);
+    GA.V[u].mapOutNgh(u, second_f, parallel);
+  };
+  if (partial) {
+    GA.V[v].mapInNgh(v, first_f, parallel);
+  } else {
+    GA.V[v].mapOutNgh(v, first_f, parallel);
+  }
+}
+
+// Smallest color not used by any vertex map_two_hop visits from v. The
+// number of paths bounds the number of forbidden colors.
+template <template <typename W> class vertex, class W, class Seq>
+inline uintE color_two_hop(graph<vertex<W>>& GA, uintE v, bool partial,
+                           Seq& colors, color_bitsets& bitsets) {
+  auto deg_f = [&](const uintE& src, const uintE& u, const W& wgh) {
+    return (size_t)GA.V[u].getOutDegree() + (partial ? 0 : 1);
+  };
+  auto monoid = pbbslib::addm<size_t>();
+  size_t paths = partial
+      ? GA.V[v].template reduceInNgh<size_t>(v, deg_f, monoid)
+      : GA.V[v].template reduceOutNgh<size_t>(v, deg_f, monoid);
+  size_t words = paths / 64 + 1;
+  uint64_t* bits = bitsets.get(words);
+  auto map_f = [&](const uintE& w) {
+    uintE color = colors[w];
+    if (color <= paths) {
+      bits[color >> 6] |= ((uint64_t)1) << (color & 63);
+    }
+  };
+  map_two_hop(GA, v, partial, map_f, false);
+  for (size_t i = 0; i < words; i++) {
+    if (~bits[i]) return (i << 6) + __builtin_ctzll(~bits[i]);
+  }
+  return paths;  // unreachable
+}
+
+// Counts the roots adjacent to each vertex; a vertex is emitted on its first
+// hit.
+template <class W>
+struct hit_f {
+  uintE* hits;
+  hit_f(uintE* _hits) : hits(_hits) {}
+  inline bool update(const uintE& s, const uintE& d, const W& w) {
+    hits[d]++;
+    return hits[d] == 1;
+  }
+  inline bool updateAtomic(const uintE& s, const uintE& d, const W& w) {
+    return pbbslib::fetch_and_add(&hits[d], (uintE)1) == 0;
+  }
+  inline bool cond(uintE d) { return true; }
+};
+
+// Removes the paths from newly colored roots that go through s from the
+// priority of d, emitting d once its priority reaches zero.
+template <class W>
+struct two_hop_f {
+  uintE* hits;
+  long* p;
+  two_hop_f(uintE* _hits, long* _p) : hits(_hits), p(_p) {}
+  inline bool update(const uintE& s, const uintE& d, const W& w) {
+    p[d] -= hits[s];
+    return p[d] == 0;
+  }
+  inline bool updateAtomic(const uintE& s, const uintE& d, const W& w) {
+    long h = hits[s];
+    return pbbslib::fetch_and_add(&p[d], -h) == h;
+  }
+  inline bool cond(uintE d) { return (p[d] > 0); }
+};
 }  // namespace coloring
 
 template <class W>
@@ -119,7 +248,7 @@ inline sequence<uintE> Coloring(graph<vertex<W>>& GA, bool lf = false) {
       // breaks ties using P
       auto count_f = [&](uintE src, uintE ngh, const W& wgh) {
         uintE ngh_deg = pbbslib::log2_up(GA.V[ngh].getOutDegree());
-        return (ngh_deg > our_deg) || ((ngh_deg == our_deg) && P[ngh] < i_p);
+        return coloring::llf_before(ngh_deg, P[ngh], our_deg, i_p);
       };
       priorities[i] = GA.V[i].countOutNgh(i, count_f);
     });
@@ -161,6 +290,152 @@ inline sequence<uintE> Coloring(graph<vertex<W>>& GA, bool lf = false) {
   return colors;
 }
 
+// Speculative iterative coloring (Gebremedhin-Manne, Catalyurek et al.).
+// Every uncolored vertex is colored optimistically in parallel, possibly
+// reading stale neighbor colors; an edge scan then finds conflicting pairs,
+// and only the endpoint with the larger id is recolored in the next round.
+// Vertices outside the active set never change color during a round, so
+// conflicts only occur between two active vertices and the loop terminates.
+template <template <typename W> class vertex, class W>
+inline sequence<uintE> ColoringSpeculative(graph<vertex<W>>& GA) {
+  const size_t n = GA.n;
+  auto colors = sequence<uintE>(n, [](size_t i) { return UINT_E_MAX; });
+  coloring::color_bitsets bitsets;
+
+  auto active = sequence<uintE>(n, [](size_t i) { return i; });
+
+  size_t rounds = 0;
+  timer color_t;
+  timer conflict_t;
+  while (active.size() > 0) {
+    color_t.start();
+    par_for(0, active.size(), 1, [&] (size_t i) {
+      uintE v = active[i];
+      colors[v] = coloring::color_bits(GA, v, colors, bitsets);
+    });
+    color_t.stop();
+
+    conflict_t.start();
+    auto conflicted = [&](uintE v) {
+      uintE c = colors[v];
+      auto pred = [&](const uintE& src, const uintE& ngh, const W& wgh) {
+        return ngh < src && colors[ngh] == c;
+      };
+      return GA.V[v].countOutNgh(v, pred) > 0;
+    };
+    active = pbbslib::filter(active, conflicted);
+    conflict_t.stop();
+    debug(std::cout << "round = " << rounds << " conflicts = "
+                    << active.size() << "\n";);
+    rounds++;
+  }
+  std::cout << "### Total rounds = " << rounds << "\n";
+  debug(color_t.reportTotal("coloring time");
+  conflict_t.reportTotal("conflict detection time"););
+  return colors;
+}
+
+// Distance-2 coloring: vertices within two hops get distinct colors. With
+// partial set (asymmetric graphs), this is instead a partial distance-2
+// coloring of the vertices with in-edges, where two vertices conflict if they
+// share an in-neighbor; e.g. for the bipartite row -> column graph of a sparse
+// Jacobian this gives a column compression. Vertices with no in-edges are left
+// uncolored (UINT_E_MAX).
+//
+// This uses the same LLF priority DAG and edgeMap rootset loop as Coloring,
+// but on two-hop paths: the priority of v is the number of paths from v to
+// vertices earlier in the LLF order, and each round decrements it by the paths
+// from the new roots, first counting the roots next to every middle vertex and
+// then pushing those counts out one more hop.
+template <template <typename W> class vertex, class W>
+inline sequence<uintE> ColoringDistance2(graph<vertex<W>>& GA,
+                                         bool partial = false) {
+  timer initt;
+  initt.start();
+  const size_t n = GA.n;
+  auto deg = [&](uintE v) {
+    return partial ? GA.V[v].getInDegree() : GA.V[v].getOutDegree();
+  };
+  auto colorable = [&](uintE v) { return !partial || deg(v) > 0; };
+
+  auto priorities = sequence<long>(n);
+  auto colors = sequence<uintE>(n, [](size_t i) { return UINT_E_MAX; });
+  auto hits = sequence<uintE>(n, [](size_t i) { return 0; });
+  coloring::color_bitsets bitsets;
+
+  std::cout << "### Running LLF"
+            << "\n";
+  auto P = pbbslib::random_permutation<uintE>(n);
+  par_for(0, n, 1, [&] (size_t i) {
+    uintE our_deg = pbbslib::log2_up(deg(i));
+    uintE i_p = P[i];
+    long ct = 0;
+    auto count_f = [&](const uintE& w) {
+      uintE w_deg = pbbslib::log2_up(deg(w));
+      if (coloring::llf_before(w_deg, P[w], our_deg, i_p)) ct++;
+    };
+    coloring::map_two_hop(GA, i, partial, count_f, false);
+    priorities[i] = ct;
+  });
+
+  auto zero_map_f = [&](size_t i) {
+    return colorable(i) && priorities[i] == 0;
+  };
+  auto zero_map = pbbslib::make_sequence<bool>(n, zero_map_f);
+  auto roots = vertexSubset(n, pbbslib::pack_index<uintE>(zero_map));
+  auto colorable_im = pbbslib::make_sequence<size_t>(
+      n, [&](size_t i) { return (size_t)colorable(i); });
+  size_t n_colorable = pbbslib::reduce_add(colorable_im);
+  debug(initt.reportTotal("init time"););
+
+  size_t finished = 0, rounds = 0;
+  timer color_t;
+  timer em_t;
+  while (finished != n_colorable) {
+    assert(roots.size() > 0);
+    finished += roots.size();
+    roots.toSparse();
+
+    // color the rootset
+    color_t.start();
+    par_for(0, roots.size(), 1, [&] (size_t i) {
+      uintE v = roots.vtx(i);
+      colors[v] = coloring::color_two_hop(GA, v, partial, colors, bitsets);
+    });
+    color_t.stop();
+
+    // compute the new rootset. A root is its own middle vertex for the
+    // one-hop paths, so it starts with one hit.
+    em_t.start();
+    if (!partial) {
+      par_for(0, roots.size(), [&] (size_t i) { hits[roots.vtx(i)] = 1; });
+    }
+    auto mids = edgeMap(GA, roots, coloring::hit_f<W>(hits.begin()), -1,
+                        partial ? (sparse_blocked | in_edges) : sparse_blocked);
+    mids.toSparse();
+    size_t n_roots = partial ? 0 : roots.size();
+    auto mid_seq = sequence<uintE>(n_roots + mids.size(), [&](size_t i) {
+      return (i < n_roots) ? roots.vtx(i) : mids.vtx(i - n_roots);
+    });
+    auto mid_vs = vertexSubset(n, std::move(mid_seq));
+    auto new_roots = edgeMap(
+        GA, mid_vs, coloring::two_hop_f<W>(hits.begin(), priorities.begin()),
+        -1, sparse_blocked);
+    mid_vs.toSparse();
+    par_for(0, mid_vs.size(), [&] (size_t i) { hits[mid_vs.vtx(i)] = 0; });
+    em_t.stop();
+    mids.del();
+    mid_vs.del();
+    roots.del();
+    roots = new_roots;
+    rounds++;
+  }
+  std::cout << "### Total rounds = " << rounds << "\n";
+  debug(color_t.reportTotal("coloring time");
+  em_t.reportTotal("edge map time"););
+  return colors;
+}
+
 template <template <typename W> class vertex, class W, class Seq>
 inline void verify_coloring(graph<vertex<W>>& G, Seq& colors) {
   size_t n = G.n;
@@ -186,3 +461,31 @@ inline void verify_coloring(graph<vertex<W>>& G, Seq& colors) {
               << "\n";
   }
 }
+
+template <template <typename W> class vertex, class W, class Seq>
+inline void verify_coloring_distance2(graph<vertex<W>>& G, Seq& colors,
+                                      bool partial) {
+  size_t n = G.n;
+  auto bad = sequence<bool>(n);
+  par_for(0, n, 1, [&] (size_t i) {
+    uintE src_color = colors[i];
+    bool colorable = !partial || G.V[i].getInDegree() > 0;
+    bool b = colorable && (src_color == UINT_E_MAX);
+    auto check_f = [&](const uintE& w) {
+      if (colors[w] == src_color && src_color != UINT_E_MAX) b = true;
+    };
+    coloring::map_two_hop(G, i, partial, check_f, false);
+    bad[i] = b;
+  });
+  auto im_f = [&](size_t i) { return (size_t)bad[i]; };
+  auto im = pbbslib::make_sequence<size_t>(n, im_f);
+  size_t ct = pbbslib::reduce_add(im);
+  std::cout << "ct = " << ct << "\n";
+  if (ct > 0) {
+    std::cout << "Invalid coloring"
+              << "\n";
+  } else {
+    std::cout << "Valid coloring"
+              << "\n";
+  }
+}
@@ -0,0 +1,449 @@
+// This code is part of the project "Theoretically Efficient Parallel Graph
+// Algorithms Can Be Fast and Scalable", presented at Symposium on Parallelism
+// in Algorithms and Architectures, 2018.
+// Copyright (c) 2018 Laxman Dhulipala, Guy Blelloch, and Julian Shun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all  copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Contraction hierarchies for point-to-point shortest paths on symmetric
+// weighted graphs. Vertices are contracted in rounds. Each round contracts an
+// independent set of low-degree vertices, computed with MIS_luby on the
+// subgraph induced by the candidates. Contracting v adds a shortcut {u, w} of
+// weight w(u, v) + w(v, w) for every pair of neighbors unless a bounded
+// witness search finds a path between u and w that avoids the vertices
+// contracted in this round and is no longer. The edges of v to the vertices
+// still remaining when it is contracted are its upward edges. Vertices whose
+// degree exceeds max_degree are never contracted; they form a core whose
+// edges are all kept as upward edges, in both directions.
+//
+// A query runs a Dijkstra search from s and one from t, each following only
+// upward edges, and returns the minimum of d_s(v) + d_t(v). Queries only
+// settle a small part of the graph, so each query is sequential and batches
+// of queries run in parallel.
+
+#pragma once
+
+#include <fstream>
+#include <vector>
+
+#include "ligra.h"
+#include "MIS.h"
+
+namespace ch {
+
+using wedge = std::tuple<uintE, intE>;
+using shortcut = std::tuple<uintE, uintE, intE>;
+
+// Maximum number of vertices settled by one witness search. Failing to find
+// a witness only adds a redundant shortcut.
+constexpr size_t kWitnessSettleLimit = 100;
+
+// The upward graph in CSR format.
+struct hierarchy {
+  size_t n;
+  size_t m;
+  sequence<uintT> offsets;  // n + 1 entries
+  sequence<wedge> edges;
+  sequence<uintE> level;  // contraction round; UINT_E_MAX for the core
+
+  hierarchy() : n(0), m(0) {}
+  hierarchy(size_t _n, size_t _m) : n(_n), m(_m) {
+    offsets = sequence<uintT>(n + 1);
+    edges = sequence<wedge>(m);
+    level = sequence<uintE>(n);
+  }
+
+  void write(const std::string& fname) const {
+    std::ofstream out(fname, std::ofstream::out | std::ios::binary);
+    if (!out.is_open()) {
+      std::cout << "Unable to open file " << fname << "\n";
+      abort();
+    }
+    uint64_t header[2] = {n, m};
+    out.write((char*)header, sizeof(header));
+    out.write((char*)offsets.begin(), (n + 1) * sizeof(uintT));
+    out.write((char*)edges.begin(), m * sizeof(wedge));
+    out.write((char*)level.begin(), n * sizeof(uintE));
+    out.close();
+  }
+
+  // Returns false if fname does not exist; aborts if it holds a hierarchy
+  // for a graph with a different number of vertices.
+  bool read(const std::string& fname, size_t _n) {
+    std::ifstream in(fname, std::ifstream::in | std::ios::binary);
+    if (!in.is_open()) return false;
+    uint64_t header[2];
+    in.read((char*)header, sizeof(header));
+    if (!in || header[0] != _n) {
+      std::cout << "Hierarchy file " << fname << " does not match the graph"
+                << "\n";
+      abort();
+    }
+    *this = hierarchy(header[0], header[1]);
+    in.read((char*)offsets.begin(), (n + 1) * sizeof(uintT));
+    in.read((char*)edges.begin(), m * sizeof(wedge));
+    in.read((char*)level.begin(), n * sizeof(uintE));
+    if (!in) {
+      std::cout << "Hierarchy file " << fname << " is truncated"
+                << "\n";
+      abort();
+    }
+    in.close();
+    return true;
+  }
+};
+
+// Sorts the neighbors of a vertex, keeping the lightest of parallel edges.
+inline sequence<wedge> merge_parallel(sequence<wedge>& nghs) {
+  auto less = [](const wedge& a, const wedge& b) { return a < b; };
+  std::sort(nghs.begin(), nghs.end(), less);
+  size_t k = 0;
+  for (size_t i = 0; i < nghs.size(); i++) {
+    if (k == 0 || std::get<0>(nghs[i]) != std::get<0>(nghs[k - 1])) {
+      nghs[k++] = nghs[i];
+    }
+  }
+  return sequence<wedge>(k, [&](size_t i) { return nghs[i]; });
+}
+
+// Concatenates the sequences in seqs.
+template <class T>
+inline sequence<T> flatten(sequence<sequence<T>>& seqs) {
+  auto offs = sequence<size_t>(seqs.size() + 1,
+                               [&](size_t i) { return (i < seqs.size()) ? seqs[i].size() : 0; });
+  size_t total = pbbslib::scan_add_inplace(offs);
+  auto out = sequence<T>::no_init(total);
+  par_for(0, seqs.size(), 1, [&] (size_t i) {
+    for (size_t j = 0; j < seqs[i].size(); j++) {
+      out[offs[i] + j] = seqs[i][j];
+    }
+  });
+  return out;
+}
+
+// Scratch space for one sequential Dijkstra search. Distances live in an
+// array over all vertices that is reset through the list of touched vertices,
+// so a search costs time proportional to the part of the graph it explores.
+struct search_space {
+  using entry = std::tuple<uintE, uintE>;  // (distance, vertex)
+  sequence<uintE> dist;
+  std::vector<uintE> seen;
+  std::vector<entry> heap;
+
+  inline uintE get(uintE v) const { return dist[v]; }
+  inline void relax(uintE v, uintE d) {
+    if (dist[v] == INT_E_MAX) seen.push_back(v);
+    dist[v] = d;
+    heap.push_back(std::make_tuple(d, v));
+    std::push_heap(heap.begin(), heap.end(), std::greater<entry>());
+  }
+  inline bool empty() const { return heap.empty(); }
+  inline entry pop() {
+    std::pop_heap(heap.begin(), heap.end(), std::greater<entry>());
+    auto top = heap.back();
+    heap.pop_back();
+    return top;
+  }
+  inline void reset() {
+    for (auto v : seen) dist[v] = INT_E_MAX;
+    seen.clear();
+    heap.clear();
+  }
+};
+
+// k search spaces per worker, allocated on first use.
+struct search_spaces {
+  size_t n, k;
+  search_space* spaces;
+  search_spaces(size_t _n, size_t _k) : n(_n), k(_k) {
+    spaces = new search_space[num_workers() * k];
+  }
+  ~search_spaces() { delete[] spaces; }
+
+  search_space& get(size_t i = 0) {
+    auto& sp = spaces[worker_id() * k + i];
+    if (sp.dist.size() == 0) {
+      sp.dist = sequence<uintE>(n, [](size_t i) { return INT_E_MAX; });
+    }
+    return sp;
+  }
+};
+
+// Returns the shortcuts needed to contract v. For each neighbor u, a
+// sequential Dijkstra search looks for witness paths from u to the later
+// neighbors of v that avoid the vertices in this round. The search stops once
+// it has settled every target, passed the longest path through v, or settled
+// kWitnessSettleLimit vertices.
+inline sequence<shortcut> contract(uintE v, sequence<sequence<wedge>>& adj,
+                                   bool* in_round, search_space& sp) {
+  auto& nghs = adj[v];
+  size_t deg = nghs.size();
+  if (deg < 2) return sequence<shortcut>();
+  auto out = std::vector<shortcut>();
+  for (size_t a = 0; a + 1 < deg; a++) {
+    uintE u = std::get<0>(nghs[a]);
+    uintE w_uv = std::get<1>(nghs[a]);
+    intE max_out = 0;
+    for (size_t b = a + 1; b < deg; b++) {
+      max_out = std::max(max_out, std::get<1>(nghs[b]));
+    }
+    uintE bound = w_uv + max_out;
+    size_t targets = deg - a - 1;
+    auto is_target = [&](uintE x) {
+      for (size_t b = a + 1; b < deg; b++) {
+        if (std::get<0>(nghs[b]) == x) return true;
+      }
+      return false;
+    };
+    sp.relax(u, 0);
+    size_t settled = 0;
+    while (!sp.empty() && targets > 0 && settled < kWitnessSettleLimit) {
+      auto top = sp.pop();
+      uintE d = std::get<0>(top), x = std::get<1>(top);
+      if (d > sp.get(x)) continue;
+      settled++;
+      if (is_target(x)) targets--;
+      for (auto& e : adj[x]) {
+        uintE y = std::get<0>(e);
+        if (in_round[y]) continue;
+        uintE nd = d + std::get<1>(e);
+        if (nd <= bound && nd < sp.get(y)) {
+          sp.relax(y, nd);
+        }
+      }
+    }
+    for (size_t b = a + 1; b < deg; b++) {
+      uintE w = std::get<0>(nghs[b]);
+      uintE via_v = w_uv + std::get<1>(nghs[b]);
+      if (sp.get(w) > via_v) {
+        out.push_back(std::make_tuple(u, w, (intE)via_v));
+      }
+    }
+    sp.reset();
+  }
+  return sequence<shortcut>(out.size(), [&](size_t i) { return out[i]; });
+}
+
+}  // namespace ch
+
+template <template <class W> class vertex, class W>
+inline ch::hierarchy ContractionHierarchy(graph<vertex<W>>& G,
+                                          size_t max_degree = 1000) {
+  using namespace ch;
+  size_t n = G.n;
+  timer it;
+  it.start();
+
+  // Mutable adjacency lists of the vertices that are not yet contracted.
+  auto adj = sequence<sequence<wedge>>(n);
+  par_for(0, n, 1, [&] (size_t v) {
+    auto nghs = sequence<wedge>(G.V[v].getOutDegree());
+    size_t k = 0;
+    auto map_f = [&](const uintE& u, const uintE& ngh, const W& wgh) {
+      if (ngh != u) nghs[k++] = std::make_tuple(ngh, (intE)wgh);
+    };
+    G.V[v].mapOutNgh(v, map_f, false);
+    auto trimmed = sequence<wedge>(k, [&](size_t i) { return nghs[i]; });
+    adj[v] = merge_parallel(trimmed);
+  });
+  auto up = sequence<sequence<wedge>>(n);
+  auto level = sequence<uintE>(n, [](size_t i) { return UINT_E_MAX; });
+  auto in_round = sequence<bool>(n, false);
+  auto is_candidate = sequence<bool>(n, false);
+  auto touched = sequence<bool>(n, false);
+  auto index = sequence<uintE>(n);
+  auto sc_start = sequence<size_t>(n);
+  auto sc_end = sequence<size_t>(n, [](size_t i) { return 0; });
+  auto remaining = sequence<uintE>(n, [](size_t i) { return i; });
+  auto spaces = search_spaces(n, 1);
+  it.stop();
+  it.reportTotal("init time");
+
+  size_t rounds = 0, num_shortcuts = 0;
+  timer mis_t, contract_t, update_t;
+  while (remaining.size() > 0) {
+    // 1. Candidates are the remaining vertices with at most the average
+    // remaining degree.
+    auto deg_im = pbbslib::make_sequence<size_t>(
+        remaining.size(), [&](size_t i) { return adj[remaining[i]].size(); });
+    size_t avg_deg = pbbslib::reduce_add(deg_im) / remaining.size() + 1;
+    size_t threshold = std::min(avg_deg, max_degree);
+    auto candidates = pbbslib::filter(
+        remaining, [&](uintE v) { return adj[v].size() <= threshold; });
+    if (candidates.size() == 0) break;
+
+    // 2. Pick an independent set of candidates using MIS on the subgraph
+    // induced by the candidates.
+    mis_t.start();
+    size_t nc = candidates.size();
+    par_for(0, nc, pbbslib::kSequentialForThreshold, [&] (size_t i) {
+      is_candidate[candidates[i]] = true;
+      index[candidates[i]] = i;
+    });
+    auto cand_edges = sequence<sequence<std::tuple<uintE, uintE, pbbslib::empty>>>(nc);
+    par_for(0, nc, 1, [&] (size_t i) {
+      uintE v = candidates[i];
+      auto c_nghs = pbbslib::filter(
+          adj[v], [&](const wedge& e) { return is_candidate[std::get<0>(e)]; });
+      cand_edges[i] = sequence<std::tuple<uintE, uintE, pbbslib::empty>>(
+          c_nghs.size(), [&](size_t j) {
+            return std::make_tuple((uintE)i, index[std::get<0>(c_nghs[j])],
+                                   pbbslib::empty());
+          });
+    });
+    auto E = flatten(cand_edges);
+    auto A = edge_array<pbbslib::empty>(E.to_array(), nc, nc, E.size());
+    auto GC = sym_graph_from_edges(A);
+    A.del();
+    auto in_mis = MIS_luby::MIS(GC);
+    GC.del();
+    auto I = pbbslib::pack(candidates, in_mis);
+    par_for(0, nc, pbbslib::kSequentialForThreshold, [&] (size_t i)
+                    { is_candidate[candidates[i]] = false; });
+    par_for(0, I.size(), pbbslib::kSequentialForThreshold, [&] (size_t i)
+                    { in_round[I[i]] = true; });
+    mis_t.stop();
+
+    // 3. Compute the shortcuts for the vertices in I.
+    contract_t.start();
+    auto scs = sequence<sequence<shortcut>>(I.size());
+    par_for(0, I.size(), 1, [&] (size_t i) {
+      scs[i] = contract(I[i], adj, in_round.begin(), spaces.get());
+    });
+    auto half = flatten(scs);
+    num_shortcuts += half.size();
+    auto all = sequence<shortcut>(2 * half.size(), [&](size_t i) {
+      auto e = half[i / 2];
+      return (i & 1) ? std::make_tuple(std::get<1>(e), std::get<0>(e),
+                                       std::get<2>(e))
+                     : e;
+    });
+    contract_t.stop();
+
+    // 4. Move the edges of I to the upward graph, and update the adjacency
+    // lists of their neighbors.
+    update_t.start();
+    auto first = [](const shortcut& e) { return std::get<0>(e); };
+    pbbslib::integer_sort_inplace(all.slice(), first, pbbslib::log2_up(n));
+    par_for(0, all.size(), pbbslib::kSequentialForThreshold, [&] (size_t i) {
+      uintE s = std::get<0>(all[i]);
+      if (i == 0 || s != std::get<0>(all[i - 1])) sc_start[s] = i;
+      if (i == all.size() - 1 || s != std::get<0>(all[i + 1])) sc_end[s] = i + 1;
+    });
+    auto ngh_lists = sequence<sequence<uintE>>(I.size());
+    par_for(0, I.size(), 1, [&] (size_t i) {
+      uintE v = I[i];
+      level[v] = rounds;
+      auto& nghs = adj[v];
+      ngh_lists[i] = sequence<uintE>(nghs.size(), [&](size_t j) {
+        uintE u = std::get<0>(nghs[j]);
+        return (!touched[u] && pbbslib::CAS(&touched[u], false, true))
+                   ? u : UINT_E_MAX;
+      });
+      up[v] = std::move(adj[v]);
+    });
+    auto all_nghs = flatten(ngh_lists);
+    auto to_update =
+        pbbslib::filter(all_nghs, [](uintE u) { return u != UINT_E_MAX; });
+    par_for(0, to_update.size(), 1, [&] (size_t i) {
+      uintE u = to_update[i];
+      auto kept = pbbslib::filter(
+          adj[u], [&](const wedge& e) { return !in_round[std::get<0>(e)]; });
+      size_t s = sc_start[u], e = sc_end[u];
+      size_t n_new = (e > s) ? e - s : 0;
+      auto merged = sequence<wedge>(kept.size() + n_new, [&](size_t j) {
+        if (j < kept.size()) return kept[j];
+        auto sc = all[s + j - kept.size()];
+        return std::make_tuple(std::get<1>(sc), std::get<2>(sc));
+      });
+      adj[u] = merge_parallel(merged);
+      touched[u] = false;
+      sc_end[u] = 0;
+    });
+    par_for(0, I.size(), pbbslib::kSequentialForThreshold, [&] (size_t i)
+                    { in_round[I[i]] = false; });
+    remaining = pbbslib::filter(remaining,
+                                [&](uintE v) { return level[v] == UINT_E_MAX; });
+    update_t.stop();
+    rounds++;
+  }
+  mis_t.reportTotal("MIS time");
+  contract_t.reportTotal("contraction time");
+  update_t.reportTotal("update time");
+
+  // The remaining vertices form the core.
+  par_for(0, remaining.size(), 1, [&] (size_t i) {
+    uintE v = remaining[i];
+    up[v] = std::move(adj[v]);
+  });
+
+  auto offs = sequence<uintT>(n + 1, [&](size_t i) { return (i < n) ? up[i].size() : 0; });
+  size_t m = pbbslib::scan_add_inplace(offs);
+  auto H = hierarchy(n, m);
+  par_for(0, n + 1, pbbslib::kSequentialForThreshold, [&] (size_t i)
+                  { H.offsets[i] = offs[i]; });
+  par_for(0, n, 1, [&] (size_t v) {
+    H.level[v] = level[v];
+    for (size_t j = 0; j < up[v].size(); j++) {
+      H.edges[offs[v] + j] = up[v][j];
+    }
+  });
+  std::cout << "rounds = " << rounds << " shortcuts = " << num_shortcuts
+            << " core size = " << remaining.size()
+            << " upward edges = " << m << "\n";
+  return H;
+}
+
+// Returns d(src, dst), or INT_E_MAX if dst is not reachable from src. The
+// two upward searches alternate; a side stops once its smallest tentative
+// distance is at least the best meeting distance found so far.
+inline uintE CH_query(const ch::hierarchy& H, uintE src, uintE dst,
+                      ch::search_spaces& spaces) {
+  ch::search_space* sp[2] = {&spaces.get(0), &spaces.get(1)};
+  sp[0]->relax(src, 0);
+  sp[1]->relax(dst, 0);
+  uintE best = INT_E_MAX;
+  size_t side = 0;
+  while (!sp[0]->empty() || !sp[1]->empty()) {
+    if (sp[side]->empty()) side = 1 - side;
+    auto& fwd = *sp[side];
+    auto& bwd = *sp[1 - side];
+    auto top = fwd.pop();
+    uintE d = std::get<0>(top), v = std::get<1>(top);
+    if (d >= best) {
+      // Nothing left on this side can improve best.
+      fwd.heap.clear();
+    } else if (d <= fwd.get(v)) {
+      if (bwd.get(v) != INT_E_MAX) {
+        best = std::min(best, d + bwd.get(v));
+      }
+      for (size_t j = H.offsets[v]; j < H.offsets[v + 1]; j++) {
+        uintE u = std::get<0>(H.edges[j]);
+        uintE nd = d + std::get<1>(H.edges[j]);
+        if (nd < fwd.get(u)) {
+          fwd.relax(u, nd);
+        }
+      }
+    }
+    side = 1 - side;
+  }
+  sp[0]->reset();
+  sp[1]->reset();
+  return best;
+}
@@ -24,6 +24,30 @@
 #include "ligra.h"
 #include "KCore.h"
 
+#include <fstream>
+
+struct densest_subgraph {
+  double density;           // (2 * #edges) / #vertices of the subgraph
+  sequence<uintE> vertices;  // the vertices inducing the subgraph
+
+  densest_subgraph() : density(0.0) {}
+
+  // Writes the vertices of the subgraph, one per line.
+  void write(const std::string& fname) const {
+    std::ofstream out(fname);
+    for (size_t i = 0; i < vertices.size(); i++) {
+      out << vertices[i] << "\n";
+    }
+  }
+};
+
+// Returns the vertices v with keep[v] set.
+template <class F>
+inline sequence<uintE> collect_vertices(size_t n, F keep) {
+  auto in_seq = pbbs::delayed_seq<uintE>(n, [&] (size_t i) { return i; });
+  return pbbslib::filter(in_seq, keep);
+}
+
 // (2+2\epsilon)-appx DS for undirected graph (Bahmani et al.)
 // DS = \nullset
 // While some vertices remain:
@@ -35,7 +59,7 @@
 // Implements a work-inefficient version of the Bahmani et al. appx algorithm.
 // The algorithm scans all vertices each round. The total work is O(m+n\log n).
 template <template <typename W> class vertex, class W>
-void WorkInefficientDensestSubgraph(graph<vertex<W> >& GA, double epsilon = 0.001) {
+densest_subgraph WorkInefficientDensestSubgraph(graph<vertex<W> >& GA, double epsilon = 0.001) {
   const size_t n = GA.n;
   auto em = EdgeMap<uintE, vertex, W>(GA, std::make_tuple(UINT_E_MAX, 0), (size_t)GA.m / 15);
 
@@ -43,9 +67,11 @@ void WorkInefficientDensestSubgraph(graph<vertex<W> >& GA, double epsilon = 0.00
 
   auto bits = sequence<bool>(n, true);
   auto D = sequence<uintE>(n, [&](size_t i) { return GA.V[i].getOutDegree(); });
+  // The round in which each vertex is peeled.
+  auto peeled_round = sequence<uintE>(n, UINT_E_MAX);
 
   long vertices_remaining = n;
-  size_t round = 1;
+  size_t round = 1, max_round = 1;
   double max_density = 0.0;
   while (vertices_remaining > 0) {
 
@@ -62,6 +88,7 @@ void WorkInefficientDensestSubgraph(graph<vertex<W> >& GA, double epsilon = 0.00
     std::cout << "density on round " << round << " is " << density << std::endl;);
     if (density > max_density) {
       max_density = density;
+      max_round = round;
     }
 
     // filter out peeled vertices
@@ -73,6 +100,7 @@ void WorkInefficientDensestSubgraph(graph<vertex<W> >& GA, double epsilon = 0.00
       bool active = bits[i];
       if (active && D[i] <= target_density) {
         bits[i] = false;
+        peeled_round[i] = round;
         return true;
       };
       return false;
@@ -100,10 +128,14 @@ void WorkInefficientDensestSubgraph(graph<vertex<W> >& GA, double epsilon = 0.00
     round++;
   }
   cout << "### Density of (2(1+\eps))-Densest Subgraph is: " << max_density << endl;
+  densest_subgraph DS;
+  DS.density = max_density;
+  DS.vertices = collect_vertices(n, [&] (uintE v) { return peeled_round[v] >= max_round; });
+  return DS;
 }
 
 template <template <typename W> class vertex, class W>
-void WorkEfficientDensestSubgraph(graph<vertex<W> >& GA, double epsilon = 0.001) {
+densest_subgraph WorkEfficientDensestSubgraph(graph<vertex<W> >& GA, double epsilon = 0.001) {
   const size_t n = GA.n;
   auto em = EdgeMap<uintE, vertex, W>(GA, std::make_tuple(UINT_E_MAX, 0), (size_t)GA.m / 15);
 
@@ -117,8 +149,11 @@ void WorkEfficientDensestSubgraph(graph<vertex<W> >& GA, double epsilon = 0.001)
   uintE* last_arr = nullptr;
   size_t remaining_offset = 0;
   size_t num_vertices_remaining = n;
+  // The round in which each vertex is peeled.
+  auto peeled_round = sequence<uintE>(n, UINT_E_MAX);
 
   double max_density = 0.0;
+  size_t max_round = 1;
 
   // First round
   {
@@ -130,6 +165,7 @@ void WorkEfficientDensestSubgraph(graph<vertex<W> >& GA, double epsilon = 0.001)
     std::cout << "Current density on round " << round << " is " << current_density << std::endl;);
     if (current_density > max_density) {
       max_density = current_density;
+      max_round = round;
     }
 
     auto keep_seq = pbbs::delayed_seq<bool>(n, [&] (size_t i) {
@@ -140,6 +176,7 @@ void WorkEfficientDensestSubgraph(graph<vertex<W> >& GA, double epsilon = 0.001)
     uintE* this_arr = split_vtxs_m.first.to_array();
     size_t num_removed = split_vtxs_m.second;
     auto vs = vertexSubset(n, num_removed, this_arr);
+    vertexMap(vs, [&] (uintE v) { peeled_round[v] = round; });
     debug(std::cout << "removing " << num_removed << " vertices" << std::endl;);
 
     auto apply_f = [&](const std::tuple<uintE, uintE>& p)
@@ -180,6 +217,7 @@ void WorkEfficientDensestSubgraph(graph<vertex<W> >& GA, double epsilon = 0.001)
     std::cout << "Current density on round " << round << " is " << current_density << std::endl;);
     if (current_density > max_density) {
       max_density = current_density;
+      max_round = round;
     }
 
     auto keep_seq = pbbs::delayed_seq<bool>(vtxs_remaining.size(), [&] (size_t i) {
@@ -190,6 +228,7 @@ void WorkEfficientDensestSubgraph(graph<vertex<W> >& GA, double epsilon = 0.001)
     uintE* this_arr = split_vtxs_m.first.to_array();
     size_t num_removed = split_vtxs_m.second;
     auto vs = vertexSubset(n, num_removed, this_arr);
+    vertexMap(vs, [&] (uintE v) { peeled_round[v] = round; });
     debug(std::cout << "removing " << num_removed << " vertices" << std::endl;);
 
     num_vertices_remaining -= num_removed;
@@ -218,27 +257,27 @@ void WorkEfficientDensestSubgraph(graph<vertex<W> >& GA, double epsilon = 0.001)
     pbbs::free_array(last_arr);
   }
   cout << "### Density of (2(1+\eps))-Densest Subgraph is: " << max_density << endl;
+  densest_subgraph DS;
+  DS.density = max_density;
+  DS.vertices = collect_vertices(n, [&] (uintE v) { return peeled_round[v] >= max_round; });
+  return DS;
 }
 
-// Implements a parallel version of Charikar's 2-appx that runs in O(m+n)
-// expected work and O(\rho\log n) depth w.h.p.
+// Returns the densest suffix of the peeling order of GA: the subgraph induced by
+// order[i..n) for the i maximizing its density.
 template <template <typename W> class vertex, class W>
-void CharikarAppxDensestSubgraph(graph<vertex<W> >& GA) {
-  // deg_ord = degeneracy_order(GA)
-  // ## Now, density check for graph after removing each vertex, in the peeling-order.
+densest_subgraph DensestSuffix(graph<vertex<W> >& GA, uintE* order) {
   // Let S = stores 2*#edges to vertices > in degeneracy order. Note that 2* is
   //         needed since higher-ordered vertices don't have the edge to us.
   //
   // S = scan_add(S, fl_inplace | fl_reverse) ## reverse scan
   // density w/o vertex_i = S[i] / (n - i)
   // Compute the max over all v.
-
   size_t n = GA.n;
-  auto degeneracy_order = DegeneracyOrder(GA);
   auto vtx_to_position = sequence<uintE>(n);
 
   parallel_for(0, n, [&] (size_t i) {
-    uintE v = degeneracy_order.A[i];
+    uintE v = order[i];
     vtx_to_position[v] = i;
   });
 
@@ -261,13 +300,53 @@ void CharikarAppxDensestSubgraph(graph<vertex<W> >& GA) {
     exit(0);
   }
 
-  auto density_seq = pbbs::delayed_seq<double>(n, [&] (size_t i) {
+  auto density_f = [&] (size_t i) {
     size_t dens = density_above[i];
     size_t rem = n - i;
     return static_cast<double>(dens) / static_cast<double>(rem);
-  });
-  double max_density = pbbslib::reduce_max(density_seq);
-  cout << "### Density of 2-Densest Subgraph is: " << max_density << endl;
+  };
+  auto idx_seq = pbbs::delayed_seq<size_t>(n, [&] (size_t i) { return i; });
+  size_t best = pbbslib::reduce(idx_seq, pbbslib::make_monoid([&] (size_t l, size_t r) {
+    return (density_f(r) > density_f(l)) ? r : l;
+  }, (size_t)0));
+
+  densest_subgraph DS;
+  DS.density = density_f(best);
+  DS.vertices = sequence<uintE>(n - best, [&] (size_t i) { return order[best + i]; });
+  return DS;
 }
 
+// Implements a parallel version of Charikar's 2-appx that runs in O(m+n)
+// expected work and O(\rho\log n) depth w.h.p.
+template <template <typename W> class vertex, class W>
+densest_subgraph CharikarAppxDensestSubgraph(graph<vertex<W> >& GA) {
+  // deg_ord = degeneracy_order(GA)
+  // ## Now, density check for graph after removing each vertex, in the peeling-order.
+  auto degeneracy_order = DegeneracyOrder(GA);
+  auto DS = DensestSuffix(GA, degeneracy_order.A);
+  degeneracy_order.del();
+  cout << "### Density of 2-Densest Subgraph is: " << DS.density << endl;
+  return DS;
+}
 
+// Greedy++ (Boob et al.): runs num_passes peeling passes in which the key of a
+// vertex is its degree plus its load, the sum of its degrees when it was peeled
+// in the previous passes, and returns the densest suffix over all passes. The
+// first pass is Charikar's algorithm, and the density of the best suffix
+// converges to the maximum density as the number of passes grows.
+template <template <typename W> class vertex, class W>
+densest_subgraph GreedyPlusPlusDensestSubgraph(graph<vertex<W> >& GA, size_t num_passes = 8) {
+  auto load = sequence<uintE>(GA.n, (uintE)0);
+  densest_subgraph DS;
+  for (size_t pass = 0; pass < num_passes; pass++) {
+    auto order = LoadedPeelingOrder(GA, load);
+    auto cur = DensestSuffix(GA, order.A);
+    order.del();
+    debug(cout << "density after pass " << pass << " is " << cur.density << endl;);
+    if (pass == 0 || cur.density > DS.density) {
+      DS = std::move(cur);
+    }
+  }
+  cout << "### Density of Greedy++ Densest Subgraph is: " << DS.density << endl;
+  return DS;
+}
@@ -0,0 +1,272 @@
+// This code is part of the project "Theoretically Efficient Parallel Graph
+// Algorithms Can Be Fast and Scalable", presented at Symposium on Parallelism
+// in Algorithms and Architectures, 2018.
+// Copyright (c) 2018 Laxman Dhulipala, Guy Blelloch, and Julian Shun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all  copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Eccentricity, diameter and radius estimation for symmetric unweighted
+// graphs. Traversals run up to 64 BFSes at once: every vertex holds a 64-bit
+// mask of the sources that have reached it, and a frontier vertex forwards
+// the bits it received in the previous round. The diameter is computed with
+// iFUB: after a 4-sweep picks a central vertex u, the vertices farthest from
+// u are processed level by level, and the search stops as soon as the largest
+// eccentricity found exceeds twice the distance of the remaining levels.
+// Every traversal also tightens per-vertex lower bounds ecc(v) >= d(s, v), and
+// the single-source sweeps give upper bounds ecc(v) <= d(s, v) + ecc(s).
+// Eccentricities are taken within connected components, and the diameter and
+// radius are those of the component containing the start vertex.
+
+#pragma once
+
+#include "ligra.h"
+
+namespace eccentricity {
+
+constexpr size_t kLanes = 64;
+
+// seen[v] holds the sources that have reached v, visit[v] the sources that
+// reached v in the previous round (v is on their frontier), and next[v] the
+// sources reaching v in the current round.
+template <class W>
+struct MultiBFS_F {
+  uint64_t* seen;
+  uint64_t* visit;
+  uint64_t* next;
+  uint64_t all;
+  MultiBFS_F(uint64_t* _seen, uint64_t* _visit, uint64_t* _next, uint64_t _all)
+      : seen(_seen), visit(_visit), next(_next), all(_all) {}
+  inline bool update(const uintE& s, const uintE& d, const W& w) {
+    uint64_t bits = visit[s] & ~seen[d];
+    if (bits == 0) return false;
+    uint64_t old = next[d];
+    next[d] = old | bits;
+    return old == 0;
+  }
+  inline bool updateAtomic(const uintE& s, const uintE& d, const W& w) {
+    uint64_t bits = visit[s] & ~seen[d];
+    if (bits == 0 || (next[d] & bits) == bits) return false;
+    return pbbslib::fetch_and_or(&next[d], bits) == 0;
+  }
+  inline bool cond(const uintE& d) const { return (seen[d] | next[d]) != all; }
+};
+
+// Runs a BFS from each of the (at most 64) sources in a single traversal and
+// returns their eccentricities. visit_f(v, bits, round) is called in parallel
+// on every vertex v first reached in round by the sources whose lanes are set
+// in bits; each vertex is visited at most once per round. Passing in_edges in
+// fl traverses the transpose of a directed graph.
+template <template <class W> class vertex, class W, class F>
+inline sequence<uintE> bit_parallel_bfs(graph<vertex<W>>& G,
+                                        const sequence<uintE>& sources,
+                                        F visit_f, flags fl = 0) {
+  size_t n = G.n;
+  size_t k = sources.size();
+  assert(k > 0 && k <= kLanes);
+  uint64_t all = (k == kLanes) ? ~((uint64_t)0) : ((((uint64_t)1) << k) - 1);
+  auto seen = sequence<uint64_t>(n, (uint64_t)0);
+  auto visit = sequence<uint64_t>(n, (uint64_t)0);
+  auto next = sequence<uint64_t>(n, (uint64_t)0);
+
+  // Sources may repeat, so the initial frontier holds each vertex once.
+  auto start = sequence<uintE>(k);
+  size_t n_start = 0;
+  for (size_t i = 0; i < k; i++) {
+    uintE s = sources[i];
+    if (seen[s] == 0) start[n_start++] = s;
+    seen[s] |= ((uint64_t)1) << i;
+    visit[s] = seen[s];
+  }
+  auto ecc = sequence<uintE>(k, (uintE)0);
+  vertexSubset frontier(n, n_start, start.to_array());
+  uintE round = 0;
+  while (!frontier.isEmpty()) {
+    round++;
+    auto output = edgeMap(
+        G, frontier,
+        MultiBFS_F<W>(seen.begin(), visit.begin(), next.begin(), all), -1,
+        sparse_blocked | dense_parallel | fl);
+    vertexMap(frontier, [&](uintE v) { visit[v] = 0; });
+    output.toSparse();
+    auto reached = sequence<uint64_t>(output.size(), [&](size_t i) {
+      uintE v = output.vtx(i);
+      uint64_t bits = next[v];
+      visit[v] = bits;
+      seen[v] |= bits;
+      next[v] = 0;
+      visit_f(v, bits, round);
+      return bits;
+    });
+    auto or_m = pbbslib::make_monoid(
+        [](uint64_t l, uint64_t r) { return l | r; }, (uint64_t)0);
+    uint64_t lanes = pbbslib::reduce(reached, or_m);
+    for (size_t i = 0; i < k; i++) {
+      if (lanes & (((uint64_t)1) << i)) ecc[i] = round;
+    }
+    frontier.del();
+    frontier = output;
+  }
+  frontier.del();
+  return ecc;
+}
+
+struct bounds {
+  sequence<uintE> lower;  // ecc(v) >= lower[v]
+  sequence<uintE> upper;  // ecc(v) <= upper[v]
+  size_t num_bfs;
+  bounds(size_t n) : num_bfs(0) {
+    lower = sequence<uintE>(n, (uintE)0);
+    upper = sequence<uintE>(n, UINT_E_MAX);
+  }
+};
+
+// Runs bit_parallel_bfs from the sources, tightening the lower bounds of B.
+// If dist is non-null it is set to the distance from the closest source
+// (UINT_E_MAX if unreachable).
+template <template <class W> class vertex, class W>
+inline sequence<uintE> multi_bfs(graph<vertex<W>>& G,
+                                 const sequence<uintE>& sources, bounds& B,
+                                 sequence<uintE>* dist = nullptr) {
+  if (dist) {
+    *dist = sequence<uintE>(G.n, UINT_E_MAX);
+    for (size_t i = 0; i < sources.size(); i++) (*dist)[sources[i]] = 0;
+  }
+  auto visit_f = [&](uintE v, uint64_t bits, uintE round) {
+    B.lower[v] = std::max(B.lower[v], round);
+    if (dist && (*dist)[v] == UINT_E_MAX) (*dist)[v] = round;
+  };
+  auto ecc = bit_parallel_bfs(G, sources, visit_f);
+  B.num_bfs += sources.size();
+  for (size_t i = 0; i < sources.size(); i++) {
+    B.lower[sources[i]] = ecc[i];
+    B.upper[sources[i]] = ecc[i];
+  }
+  return ecc;
+}
+
+// Runs a single BFS from src and tightens the upper bounds of every vertex in
+// its component. Returns the eccentricity of src.
+template <template <class W> class vertex, class W>
+inline uintE sweep(graph<vertex<W>>& G, uintE src, bounds& B,
+                   sequence<uintE>& dist) {
+  auto srcs = sequence<uintE>(1, src);
+  uintE e = multi_bfs(G, srcs, B, &dist)[0];
+  par_for(0, G.n, pbbslib::kSequentialForThreshold, [&] (size_t v) {
+    if (dist[v] != UINT_E_MAX) {
+      B.upper[v] = std::min(B.upper[v], dist[v] + e);
+    }
+  });
+  return e;
+}
+
+// Returns the reachable vertex with the largest distance in dist; this is the
+// source itself if nothing else was reached. Unreached vertices are skipped.
+inline uintE farthest(const sequence<uintE>& dist) {
+  auto far_im = pbbslib::make_sequence<uint64_t>(dist.size(), [&](size_t v) {
+    if (dist[v] == UINT_E_MAX) return (uint64_t)0;
+    return ((((uint64_t)dist[v]) + 1) << 32) | v;
+  });
+  return pbbslib::reduce_max(far_im) & UINT_MAX;
+}
+
+}  // namespace eccentricity
+
+// Computes the diameter of the component containing start. The result is
+// (lower, upper); they are equal unless the search was cut off after
+// max_bfs traversals. B receives per-vertex eccentricity bounds.
+template <template <class W> class vertex, class W>
+inline std::tuple<uintE, uintE> Diameter(graph<vertex<W>>& G, uintE start,
+                                         eccentricity::bounds& B,
+                                         size_t max_bfs = UINT_E_MAX) {
+  using namespace eccentricity;
+  size_t n = G.n;
+  sequence<uintE> dist;
+
+  // 4-sweep: two double sweeps, each from the midpoint of the previous
+  // diametral path, bound the diameter from below and pick a central vertex.
+  uintE lb = 0;
+  uintE r = start;
+  uintE center = start;
+  for (size_t sw = 0; sw < 2; sw++) {
+    uintE ecc_r = sweep(G, r, B, dist);
+    if (ecc_r == 0) {
+      // start is isolated: its component is a single vertex.
+      std::cout << "center = " << start << " ecc(center) = 0"
+                << " #BFS = " << B.num_bfs << "\n";
+      return std::make_tuple(0, 0);
+    }
+    uintE a = farthest(dist);
+    auto dist_a = sequence<uintE>();
+    uintE ecc_a = sweep(G, a, B, dist_a);
+    uintE b = farthest(dist_a);
+    lb = std::max(lb, ecc_a);
+    // Walk back from b towards a to the midpoint of the a-b path.
+    uintE mid = b;
+    while (dist_a[mid] > ecc_a / 2) {
+      auto map_f = [&](const uintE& u, const uintE& v, const W& w) {
+        if (dist_a[v] + 1 == dist_a[u]) return v;
+        return UINT_E_MAX;
+      };
+      auto min_m = pbbslib::minm<uintE>();
+      mid = G.V[mid].template reduceOutNgh<uintE>(mid, map_f, min_m);
+    }
+    r = mid;
+    center = mid;
+  }
+
+  // iFUB from the center: once every vertex at level i or above has been a
+  // source, any remaining pair is within 2(i-1) through the center.
+  uintE ecc_u = sweep(G, center, B, dist);
+  lb = std::max(lb, ecc_u);
+  uintE ub = 2 * ecc_u;
+  for (uintE i = ecc_u; i > 0 && lb < ub && B.num_bfs < max_bfs; i--) {
+    auto level_im = pbbslib::make_sequence<bool>(n, [&](size_t v) {
+      return dist[v] == i;
+    });
+    auto level = pbbslib::pack_index<uintE>(level_im);
+    size_t done = 0;
+    while (done < level.size() && lb < ub && B.num_bfs < max_bfs) {
+      size_t k = std::min(std::min(kLanes, level.size() - done),
+                          max_bfs - B.num_bfs);
+      auto batch = sequence<uintE>(k, [&](size_t j) { return level[done + j]; });
+      auto ecc = multi_bfs(G, batch, B);
+      lb = std::max(lb, pbbslib::reduce_max(ecc));
+      done += k;
+    }
+    if (done == level.size()) ub = std::max(lb, 2 * (i - 1));
+  }
+  std::cout << "center = " << center << " ecc(center) = " << ecc_u
+            << " #BFS = " << B.num_bfs << "\n";
+  return std::make_tuple(lb, ub);
+}
+
+// Tightens the eccentricity bounds of B with BFSes from num_samples random
+// vertices, 64 per traversal.
+template <template <class W> class vertex, class W>
+inline void SampleEccentricities(graph<vertex<W>>& G, size_t num_samples,
+                                 eccentricity::bounds& B) {
+  auto r = pbbslib::random();
+  for (size_t done = 0; done < num_samples; done += eccentricity::kLanes) {
+    size_t k = std::min(eccentricity::kLanes, num_samples - done);
+    auto batch = sequence<uintE>(k, [&](size_t j) {
+      return (uintE)(r.ith_rand(done + j) % G.n);
+    });
+    eccentricity::multi_bfs(G, batch, B);
+  }
+}
@@ -0,0 +1,207 @@
+// This code is part of the project "Theoretically Efficient Parallel Graph
+// Algorithms Can Be Fast and Scalable", presented at Symposium on Parallelism
+// in Algorithms and Architectures, 2018.
+// Copyright (c) 2018 Laxman Dhulipala, Guy Blelloch, and Julian Shun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all  copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Approximate neighborhood function (HyperANF, Boldi, Rosa and Vigna). Every
+// vertex v keeps a HyperLogLog sketch of the ball B(v, t) of vertices within
+// distance t of it, and round t + 1 sets the sketch of v to the register-wise
+// max of its own sketch and those of its out-neighbors. The sketches are fixed
+// size arrays of byte registers stored contiguously, so the max compiles to
+// vector byte-max instructions.
+//
+// The sketch of v already contains the round t - 1 sketches of all of its
+// neighbors, so only neighbors whose sketch changed in the previous round can
+// add anything: each round is a vertex program whose frontier is the set of
+// changed vertices, so small rounds recompute only their in-neighbors.
+
+#pragma once
+
+#include <cmath>
+#include <fstream>
+
+#include "ligra.h"
+#include "vertex_program.h"
+
+namespace hyperanf {
+
+// A HyperLogLog sketch with 2^B registers.
+template <size_t B>
+struct sketch {
+  static constexpr size_t kRegisters = ((size_t)1) << B;
+  uint8_t r[kRegisters];
+
+  sketch() {
+    for (size_t i = 0; i < kRegisters; i++) r[i] = 0;
+  }
+
+  // The sketch of the set {v}.
+  static sketch singleton(uintE v) {
+    sketch s;
+    uint64_t h = pbbslib::hash64(v);
+    uint64_t w = h >> B;
+    s.r[h & (kRegisters - 1)] =
+        (w == 0) ? (64 - B + 1) : (__builtin_ctzll(w) + 1);
+    return s;
+  }
+
+  // Sets this sketch to the union with o, returning true if it changed.
+  inline bool merge(const sketch& o) {
+    uint8_t diff = 0;
+    for (size_t i = 0; i < kRegisters; i++) {
+      uint8_t m = std::max(r[i], o.r[i]);
+      diff |= (m ^ r[i]);
+      r[i] = m;
+    }
+    return diff != 0;
+  }
+
+  // Estimated size of the sketched set, with the small-range correction.
+  double estimate() const {
+    double m = kRegisters;
+    double alpha;
+    switch (kRegisters) {
+      case 16: alpha = 0.673; break;
+      case 32: alpha = 0.697; break;
+      case 64: alpha = 0.709; break;
+      default: alpha = 0.7213 / (1.0 + 1.079 / m);
+    }
+    double sum = 0.0;
+    size_t zeros = 0;
+    for (size_t i = 0; i < kRegisters; i++) {
+      sum += std::ldexp(1.0, -((int)r[i]));
+      zeros += (r[i] == 0);
+    }
+    double e = alpha * m * m / sum;
+    if (e <= 2.5 * m && zeros > 0) {
+      e = m * std::log(m / zeros);
+    }
+    return e;
+  }
+};
+
+struct result {
+  std::vector<double> nf;   // nf[t] estimates the number of pairs within t
+  sequence<double> reach;   // estimated number of vertices reachable from v
+
+  // Writes n followed by the reach estimate of every vertex, as binary.
+  void write(const std::string& fname) const {
+    std::ofstream out(fname, std::ofstream::out | std::ios::binary);
+    if (!out.is_open()) {
+      std::cout << "Unable to open file " << fname << "\n";
+      abort();
+    }
+    uint64_t header[1] = {reach.size()};
+    out.write((char*)header, sizeof(header));
+    out.write((char*)reach.begin(), reach.size() * sizeof(double));
+    out.close();
+  }
+
+  // Smallest (interpolated) t such that nf[t] >= alpha * nf[last].
+  double effective_diameter(double alpha = 0.9) const {
+    double target = alpha * nf.back();
+    for (size_t t = 0; t < nf.size(); t++) {
+      if (nf[t] >= target) {
+        if (t == 0) return 0.0;
+        return (t - 1) + (target - nf[t - 1]) / (nf[t] - nf[t - 1]);
+      }
+    }
+    return nf.size() - 1;
+  }
+};
+
+template <size_t B>
+struct union_f {
+  sketch<B> operator()(sketch<B> l, const sketch<B>& r) const {
+    l.merge(r);
+    return l;
+  }
+};
+
+// Vertex program for one round: next[v] is the union of cur[v] and the
+// sketches of the neighbors that changed in the previous round.
+template <size_t B>
+struct HyperANF_P {
+  using value_type = sketch<B>;
+  sketch<B>* cur;
+  sketch<B>* next;
+  pbbs::monoid<union_f<B>, sketch<B>> monoid;
+  HyperANF_P(sketch<B>* _cur, sketch<B>* _next)
+      : cur(_cur), next(_next), monoid(union_f<B>(), sketch<B>()) {}
+  template <class W>
+  inline sketch<B> gather(const uintE& v, const uintE& u, const W& w) {
+    return cur[u];
+  }
+  inline bool apply(const uintE& v, const sketch<B>& acc) {
+    next[v] = cur[v];
+    return next[v].merge(acc);
+  }
+  inline bool cond(const uintE& v) { return true; }
+};
+
+}  // namespace hyperanf
+
+// Runs at most max_rounds rounds (until no sketch changes if 0) with 2^B
+// registers per sketch. Balls are over out-edges; passing in_edges in fl
+// computes them over in-edges instead.
+template <size_t B, template <class W> class vertex, class W>
+inline hyperanf::result HyperANF(graph<vertex<W>>& G, size_t max_rounds = 0,
+                                 flags fl = 0) {
+  using S = hyperanf::sketch<B>;
+  size_t n = G.n;
+  auto cur = sequence<S>(n, [&](size_t i) { return S::singleton(i); });
+  auto next = sequence<S>(n);
+  auto reach = sequence<double>(n, [&](size_t i) { return cur[i].estimate(); });
+
+  hyperanf::result R;
+  R.nf.push_back(pbbslib::reduce_add(reach));
+
+  // v pulls from its out-neighbors, i.e. from the in-neighbors of v in the
+  // vertex program's orientation.
+  auto P = hyperanf::HyperANF_P<B>(cur.begin(), next.begin());
+  auto VP = make_vertex_program(G, P, fl ^ in_edges);
+  auto all = sequence<bool>(n, true);
+  vertexSubset frontier(n, n, all.to_array());
+  size_t round = 0;
+  while (!frontier.isEmpty() && (max_rounds == 0 || round < max_rounds)) {
+    round++;
+    vertexSubset output = VP.step(frontier);
+    output.toSparse();
+    auto delta = sequence<double>(output.size(), [&](size_t i) {
+      uintE v = output.vtx(i);
+      cur[v] = next[v];
+      double e = cur[v].estimate();
+      double d = e - reach[v];
+      reach[v] = e;
+      return d;
+    });
+    if (output.size() > 0) {
+      R.nf.push_back(R.nf.back() + pbbslib::reduce_add(delta));
+    }
+    frontier.del();
+    frontier = output;
+  }
+  frontier.del();
+  std::cout << "rounds = " << round << " dense rounds = " << VP.num_dense
+            << "\n";
+  R.reach = std::move(reach);
+  return R;
+}
@@ -153,15 +153,23 @@ inline sequence<uintE> KCore_FA(graph<vertex<W> >& GA,
   return D;
 }
 
+// Peels GA in rounds that remove every vertex of minimum key, where the key of
+// v is load[v] plus its degree among the vertices not yet peeled, and returns
+// the peeling order. The degree of every vertex at the time it is peeled is
+// added to its load, so successive calls run the passes of Greedy++ (Boob et
+// al.). With all loads zero the order is a degeneracy order.
 template <template <typename W> class vertex, class W>
-inline pbbslib::dyn_arr<uintE> DegeneracyOrder(graph<vertex<W> >& GA, size_t num_buckets = 16) {
+inline pbbslib::dyn_arr<uintE> LoadedPeelingOrder(graph<vertex<W> >& GA,
+                                                  sequence<uintE>& load,
+                                                  size_t num_buckets = 16) {
   const size_t n = GA.n;
   auto D =
       sequence<uintE>(n, [&](size_t i) { return GA.V[i].getOutDegree(); });
+  auto K = sequence<uintE>(n, [&](size_t i) { return load[i] + D[i]; });
 
   auto em = EdgeMap<uintE, vertex, W>(GA, std::make_tuple(UINT_E_MAX, 0),
                                       (size_t)GA.m / 50);
-  auto b = make_vertex_buckets(n, D, increasing, num_buckets);
+  auto b = make_vertex_buckets(n, K, increasing, num_buckets);
   timer bt;
 
   auto degeneracy_order = pbbslib::dyn_arr<uintE>(n);
@@ -178,15 +186,16 @@ inline pbbslib::dyn_arr<uintE> DegeneracyOrder(graph<vertex<W> >& GA, size_t num
 
     auto active_seq = pbbs::delayed_seq<uintE>(active.size(), [&] (size_t i) { return active.s[i]; });
     degeneracy_order.copyIn(active_seq, active.size());
+    vertexMap(active, [&](uintE v) { load[v] += D[v]; });
 
     auto apply_f = [&](const std::tuple<uintE, uintE>& p)
         -> const Maybe<std::tuple<uintE, uintE> > {
       uintE v = std::get<0>(p), edgesRemoved = std::get<1>(p);
-      uintE deg = D[v];
-      if (deg > k) {
-        uintE new_deg = std::max(deg - edgesRemoved, k);
-        D[v] = new_deg;
-        uintE bkt = b.get_bucket(new_deg);
+      if (K[v] > k) {
+        D[v] -= edgesRemoved;
+        uintE new_key = std::max(load[v] + D[v], k);
+        K[v] = new_key;
+        uintE bkt = b.get_bucket(new_key);
         return wrap(v, bkt);
       }
       return Maybe<std::tuple<uintE, uintE> >();
@@ -211,3 +220,9 @@ inline pbbslib::dyn_arr<uintE> DegeneracyOrder(graph<vertex<W> >& GA, size_t num
   b.del();
   return degeneracy_order;
 }
+
+template <template <typename W> class vertex, class W>
+inline pbbslib::dyn_arr<uintE> DegeneracyOrder(graph<vertex<W> >& GA, size_t num_buckets = 16) {
+  auto load = sequence<uintE>(GA.n, (uintE)0);
+  return LoadedPeelingOrder(GA, load, num_buckets);
+}
@@ -0,0 +1,240 @@
+// This code is part of the project "Theoretically Efficient Parallel Graph
+// Algorithms Can Be Fast and Scalable", presented at Symposium on Parallelism
+// in Algorithms and Architectures, 2018.
+// Copyright (c) 2018 Laxman Dhulipala, Guy Blelloch, and Julian Shun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all  copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Goal-directed point-to-point shortest paths using landmarks and the
+// triangle inequality (ALT). A preprocessing step computes shortest path
+// distances from (and, on directed graphs, to) k landmarks. Queries then run
+// a bucketed search in which a vertex v is placed in bucket d(s, v) + h(v),
+// where h(v) is the largest lower bound on d(v, t) given by the landmarks.
+
+#pragma once
+
+#include <fstream>
+
+#include "bucket.h"
+#include "ligra.h"
+#include "wBFS.h"
+
+namespace alt {
+
+// Distances between the landmarks and every vertex. Entries are stored
+// vertex-major (the k distances of v are contiguous), so evaluating the
+// heuristic at a vertex touches a single cache line for small k. Unreachable
+// pairs are stored as INT_E_MAX.
+struct landmark_table {
+  size_t n;
+  size_t k;
+  bool symmetric;
+  sequence<uintE> landmarks;
+  sequence<uintE> from;  // from[v*k + i] = d(landmarks[i], v)
+  sequence<uintE> to;    // to[v*k + i] = d(v, landmarks[i]); empty if symmetric
+
+  landmark_table() : n(0), k(0), symmetric(true) {}
+  landmark_table(size_t _n, size_t _k, bool _symmetric)
+      : n(_n), k(_k), symmetric(_symmetric) {
+    landmarks = sequence<uintE>(k);
+    from = sequence<uintE>(n * k);
+    if (!symmetric) {
+      to = sequence<uintE>(n * k);
+    }
+  }
+
+  // Returns a lower bound on d(v, t), or UINT_E_MAX if the landmarks show
+  // that t is not reachable from v.
+  inline uintE lower_bound(uintE v, uintE t) const {
+    const uintE* fv = from.begin() + (size_t)v * k;
+    const uintE* ft = from.begin() + (size_t)t * k;
+    const uintE* tv = symmetric ? fv : (to.begin() + (size_t)v * k);
+    const uintE* tt = symmetric ? ft : (to.begin() + (size_t)t * k);
+    uintE h = 0;
+    for (size_t i = 0; i < k; i++) {
+      // d(v, t) >= d(L, t) - d(L, v)
+      if (fv[i] != INT_E_MAX) {
+        if (ft[i] == INT_E_MAX) return UINT_E_MAX;
+        if (ft[i] > fv[i]) h = std::max(h, ft[i] - fv[i]);
+      }
+      // d(v, t) >= d(v, L) - d(t, L)
+      if (tt[i] != INT_E_MAX) {
+        if (tv[i] == INT_E_MAX) return UINT_E_MAX;
+        if (tv[i] > tt[i]) h = std::max(h, tv[i] - tt[i]);
+      }
+    }
+    return h;
+  }
+
+  void write(const std::string& fname) const {
+    std::ofstream out(fname, std::ofstream::out | std::ios::binary);
+    if (!out.is_open()) {
+      std::cout << "Unable to open file " << fname << "\n";
+      abort();
+    }
+    uint64_t header[3] = {n, k, symmetric};
+    out.write((char*)header, sizeof(header));
+    out.write((char*)landmarks.begin(), k * sizeof(uintE));
+    out.write((char*)from.begin(), n * k * sizeof(uintE));
+    if (!symmetric) {
+      out.write((char*)to.begin(), n * k * sizeof(uintE));
+    }
+    out.close();
+  }
+
+  // Returns false if fname does not exist; aborts if it holds a table for a
+  // different graph.
+  bool read(const std::string& fname, size_t _n, bool _symmetric) {
+    std::ifstream in(fname, std::ifstream::in | std::ios::binary);
+    if (!in.is_open()) return false;
+    uint64_t header[3];
+    in.read((char*)header, sizeof(header));
+    if (!in || header[0] != _n || (bool)header[2] != _symmetric) {
+      std::cout << "Landmark file " << fname << " does not match the graph"
+                << "\n";
+      abort();
+    }
+    *this = landmark_table(header[0], header[1], header[2]);
+    in.read((char*)landmarks.begin(), k * sizeof(uintE));
+    in.read((char*)from.begin(), n * k * sizeof(uintE));
+    if (!symmetric) {
+      in.read((char*)to.begin(), n * k * sizeof(uintE));
+    }
+    if (!in) {
+      std::cout << "Landmark file " << fname << " is truncated"
+                << "\n";
+      abort();
+    }
+    in.close();
+    return true;
+  }
+};
+
+// Selects k landmarks by farthest-point sampling starting from first: each
+// new landmark is a vertex maximizing its distance to the closest landmark
+// chosen so far. Each landmark costs one wBFS (two on directed graphs). A
+// vertex is never chosen twice, so k is capped at n.
+template <class vertex>
+inline landmark_table compute_landmarks(graph<vertex>& G, size_t k,
+                                        bool symmetric, uintE first,
+                                        size_t num_buckets = 32,
+                                        bool largemem = false) {
+  size_t n = G.n;
+  k = std::min(k, n);
+  auto T = landmark_table(n, k, symmetric);
+  auto closest = sequence<uintE>(n, [&](size_t i) { return INT_E_MAX; });
+  auto chosen = sequence<bool>(n, false);
+  uintE L = first;
+  for (size_t i = 0; i < k; i++) {
+    T.landmarks[i] = L;
+    chosen[L] = true;
+    auto dists = wBFS(G, L, num_buckets, largemem);
+    par_for(0, n, pbbslib::kSequentialForThreshold, [&] (size_t v) {
+      T.from[v * k + i] = dists[v];
+      closest[v] = std::min(closest[v], dists[v]);
+    });
+    if (!symmetric) {
+      auto dists_to = wBFS(G, L, num_buckets, largemem, false, false, true);
+      par_for(0, n, pbbslib::kSequentialForThreshold, [&] (size_t v)
+                      { T.to[v * k + i] = dists_to[v]; });
+    }
+    // Vertices not reached by any landmark are poor candidates, since they
+    // are likely to be in small components, but they are still preferred
+    // over the landmarks themselves (key 0).
+    auto far_f = [&](size_t v) -> uint64_t {
+      if (chosen[v]) return 0;
+      uint64_t d = (closest[v] == INT_E_MAX) ? 0 : closest[v];
+      return ((d + 1) << 32) | v;
+    };
+    auto far_im = pbbslib::make_sequence<uint64_t>(n, far_f);
+    L = pbbslib::reduce_max(far_im) & UINT_MAX;
+  }
+  return T;
+}
+
+}  // namespace alt
+
+// Computes d(src, dst) (INT_E_MAX if dst is not reachable) using the bucketed
+// search of wBFS, keyed by d(src, v) + h(v). The landmark heuristic is
+// consistent, so a vertex is settled once its bucket is processed, and the
+// search stops as soon as the current bucket is at least the tentative
+// distance to dst. Vertices that the landmarks show cannot reach dst are never
+// bucketed.
+template <
+    template <typename W> class vertex, class W,
+    typename std::enable_if<std::is_same<W, int32_t>::value, int>::type = 0>
+inline uintE ALT_query(graph<vertex<W>>& G, const alt::landmark_table& T,
+                       uintE src, uintE dst, size_t num_buckets = 32,
+                       bool largemem = false) {
+  size_t n = G.n;
+  auto dists = sequence<uintE>(n, [&](size_t i) { return INT_E_MAX; });
+  dists[src] = 0;
+
+  auto get_bkt = [&](const uintE v, const uintE& dist) -> const uintE {
+    if (dist == INT_E_MAX) return UINT_E_MAX;
+    uintE h = T.lower_bound(v, dst);
+    return (h == UINT_E_MAX) ? UINT_E_MAX : dist + h;
+  };
+  auto get_ring = pbbslib::make_sequence<uintE>(n, [&](const size_t& v) {
+    return get_bkt(v, dists[v]);
+  });
+  auto b = make_vertex_buckets(n, get_ring, increasing, num_buckets);
+
+  auto apply_f = [&](const uintE v, uintE& oldDist) -> void {
+    uintE newDist = dists[v] & wbfs::VAL_MASK;
+    dists[v] = newDist;  // Remove the TOP_BIT in the distance.
+    uintE prev_bkt = get_bkt(v, oldDist), new_bkt = get_bkt(v, newDist);
+    oldDist = (new_bkt == UINT_E_MAX) ? b.null_bkt
+                                      : b.get_bucket(prev_bkt, new_bkt);
+  };
+
+  flags fl = dense_forward | sparse_blocked;
+  if (!largemem) fl |= no_dense;
+  auto bkt = b.next_bucket();
+  size_t rd = 0, settled = 0;
+  while (bkt.id != b.null_bkt && bkt.id < dists[dst]) {
+    auto active = vertexSubset(n, bkt.identifiers);
+    settled += active.size();
+    auto res =
+        edgeMapData<uintE>(G, active, wbfs::Visit_F(dists), G.m / 20, fl);
+    vertexMap(res, apply_f);
+    if (res.dense()) {
+      b.update_buckets(res.get_fn_repr(), n);
+    } else {
+      b.update_buckets(res.get_fn_repr(), res.size());
+    }
+    res.del();
+    active.del();
+    bkt = b.next_bucket();
+    rd++;
+  }
+  b.del();
+  std::cout << "n rounds = " << rd << " settled = " << settled << "\n";
+  return dists[dst];
+}
+
+template <
+    template <typename W> class vertex, class W,
+    typename std::enable_if<!std::is_same<W, int32_t>::value, int>::type = 0>
+inline uintE ALT_query(graph<vertex<W>>& G, const alt::landmark_table& T,
+                       uintE src, uintE dst, size_t num_buckets = 32,
+                       bool largemem = false) {
+  assert(false);  // Unimplemented for unweighted graphs; use BFS_st.
+  return INT_E_MAX;
+}
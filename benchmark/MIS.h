@@ -26,6 +26,7 @@
 #include "pbbslib/random_shuffle.h"
 #include "pbbslib/sparse_table.h"
 
+#include "edge_batch.h"
 #include "speculative_for.h"
 #include "ligra.h"
 
@@ -267,16 +268,167 @@ struct MISstep {
 };
 
 template <template <class W> class vertex, class W>
-inline sequence<char> MIS(graph<vertex<W>>& GA) {
+inline sequence<char> MIS(graph<vertex<W>>& GA,
+                          spec_for_state<uintE>* st = nullptr) {
   size_t n = GA.n;
   auto Flags = sequence<char>(n, [&](size_t i) { return 0; });
   auto FlagsNext = sequence<char>(n);
   auto mis = MISstep<vertex, W>(FlagsNext.begin(), Flags.begin(), GA);
-  eff_for<uintE>(mis, 0, n, 50);
+  eff_for<uintE>(mis, 0, n, 50, 1, std::numeric_limits<long>::max(), st);
   return Flags;
 }
 };  // namespace MIS_spec_for
 
+namespace MIS_luby {
+// Vertex states are packed two bits per vertex, 32 vertices per word: bit
+// 2v is set once v is in the MIS and bit 2v+1 once a neighbor is.
+constexpr uint64_t IN = 1;
+constexpr uint64_t OUT = 2;
+
+inline uint64_t get_state(uint64_t* state, uintE v) {
+  return (state[v >> 5] >> ((v & 31) << 1)) & 3;
+}
+
+inline void set_state(uint64_t* state, uintE v, uint64_t st) {
+  uint64_t bits = st << ((v & 31) << 1);
+  if ((state[v >> 5] & bits) != bits) {
+    pbbslib::fetch_and_or(&state[v >> 5], bits);
+  }
+}
+
+// Luby-style MIS. Each round draws fresh random priorities, and an undecided
+// vertex joins the MIS if it beats all of its undecided neighbors; the
+// neighbors of the new MIS vertices are then removed. Unlike
+// MIS_rootset::MIS there is no up-front priority DAG: each round only scans
+// the adjacency lists of the vertices that are still undecided.
+template <template <class W> class vertex, class W>
+inline sequence<bool> MIS(graph<vertex<W>>& GA) {
+  size_t n = GA.n;
+  size_t n_words = (n + 31) / 32;
+  auto state = sequence<uint64_t>(n_words, [](size_t i) { return 0; });
+  uint64_t* st = state.begin();
+  auto r = pbbslib::random();
+
+  auto active = sequence<uintE>(n, [](size_t i) { return i; });
+  size_t rounds = 0;
+  while (active.size() > 0) {
+    auto rr = r.fork(rounds);
+    auto pri = [&](uintE v) { return std::make_tuple(rr.ith_rand(v), v); };
+
+    // 1. Select the undecided vertices that beat their undecided neighbors.
+    auto is_root = [&](uintE v) {
+      auto our_pri = pri(v);
+      auto pred = [&](const uintE& src, const uintE& ngh, const W& wgh) {
+        return get_state(st, ngh) == 0 && pri(ngh) < our_pri;
+      };
+      return GA.V[v].countOutNgh(v, pred) == 0;
+    };
+    auto roots = pbbslib::filter(active, is_root);
+
+    // 2. Add the roots to the MIS and remove their neighbors.
+    par_for(0, roots.size(), 1, [&] (size_t i) {
+      uintE v = roots[i];
+      set_state(st, v, IN);
+      auto map_f = [&](const uintE& src, const uintE& ngh, const W& wgh) {
+        set_state(st, ngh, OUT);
+      };
+      GA.V[v].mapOutNgh(v, map_f);
+    });
+
+    active = pbbslib::filter(
+        active, [&](uintE v) { return get_state(st, v) == 0; });
+    debug(std::cout << "round = " << rounds << " roots = " << roots.size()
+                    << " undecided = " << active.size() << "\n";);
+    rounds++;
+  }
+  std::cout << "### Total rounds = " << rounds << "\n";
+  return sequence<bool>(n, [&](size_t i) { return get_state(st, i) == IN; });
+}
+}  // namespace MIS_luby
+
+namespace MIS_dynamic {
+using edge_batch::pair;
+
+// Repairs in_mis, an MIS of the graph before the batch, into an MIS of G, the
+// graph after inserting ins and deleting del. Priorities are the fixed random
+// order of MIS_rootset::hash_lt:
+//   1. An inserted edge between two MIS vertices evicts the later one.
+//   2. Evicted vertices, their neighbors and the endpoints of deleted edges
+//      are the only vertices that can have lost their last MIS neighbor.
+//      Those that did are undecided.
+//   3. Undecided vertices join the MIS in rounds, as in MIS_luby: a vertex
+//      joins once it precedes all of its undecided neighbors.
+// Work is proportional to the degrees of the affected vertices. mark is
+// scratch space of size n that must be all false (and is left all false).
+template <template <class W> class vertex, class W>
+inline void repair(graph<vertex<W>>& G, sequence<bool>& in_mis,
+                   sequence<pair>& ins, sequence<pair>& del, bool* mark) {
+  // 1. Evict one endpoint of every inserted edge inside the MIS.
+  auto loser_f = [&](size_t i) {
+    uintE u = std::get<0>(ins[i]), v = std::get<1>(ins[i]);
+    if (!in_mis[u] || !in_mis[v]) return UINT_E_MAX;
+    return MIS_rootset::hash_lt(u, v) ? v : u;
+  };
+  auto losers_all = sequence<uintE>(ins.size(), loser_f);
+  auto losers_f = pbbslib::filter(losers_all,
+                                  [](uintE v) { return v != UINT_E_MAX; });
+  auto evicted = edge_batch::unique_vertices(losers_f, mark);
+  par_for(0, evicted.size(), pbbslib::kSequentialForThreshold, [&] (size_t i)
+                  { in_mis[evicted[i]] = false; });
+
+  // 2. Collect the vertices that may have become uncovered.
+  auto not_in = [&](const uintE& w) { return !in_mis[w]; };
+  auto evicted_nghs = edge_batch::neighbors(G, evicted, not_in, mark);
+  size_t n_ev = evicted.size(), n_en = evicted_nghs.size();
+  auto cands_all = sequence<uintE>(n_ev + n_en + 2 * del.size(), [&](size_t i) {
+    if (i < n_ev) return evicted[i];
+    if (i < n_ev + n_en) return evicted_nghs[i - n_ev];
+    auto e = del[(i - n_ev - n_en) / 2];
+    uintE v = ((i - n_ev - n_en) & 1) ? std::get<1>(e) : std::get<0>(e);
+    return in_mis[v] ? UINT_E_MAX : v;
+  });
+  auto cands_f = pbbslib::filter(cands_all,
+                                 [](uintE v) { return v != UINT_E_MAX; });
+  auto cands = edge_batch::unique_vertices(cands_f, mark);
+  auto uncovered = [&](uintE v) {
+    auto pred = [&](const uintE& src, const uintE& ngh, const W& wgh) {
+      return in_mis[ngh];
+    };
+    return !in_mis[v] && G.V[v].countOutNgh(v, pred) == 0;
+  };
+  auto undecided = pbbslib::filter(cands, uncovered);
+  size_t n_undecided = undecided.size();
+
+  // 3. Add undecided vertices in priority order; mark[v] means undecided.
+  par_for(0, undecided.size(), pbbslib::kSequentialForThreshold,
+          [&] (size_t i) { mark[undecided[i]] = true; });
+  size_t rounds = 0;
+  while (undecided.size() > 0) {
+    auto is_root = [&](uintE v) {
+      auto pred = [&](const uintE& src, const uintE& ngh, const W& wgh) {
+        return mark[ngh] && MIS_rootset::hash_lt(ngh, src);
+      };
+      return G.V[v].countOutNgh(v, pred) == 0;
+    };
+    auto roots = pbbslib::filter(undecided, is_root);
+    par_for(0, roots.size(), 1, [&] (size_t i) {
+      uintE v = roots[i];
+      in_mis[v] = true;
+      mark[v] = false;
+      auto map_f = [&](const uintE& src, const uintE& ngh, const W& wgh) {
+        if (mark[ngh]) mark[ngh] = false;
+      };
+      G.V[v].mapOutNgh(v, map_f);
+    });
+    undecided = pbbslib::filter(undecided, [&](uintE v) { return mark[v]; });
+    rounds++;
+  }
+  std::cout << "evicted = " << n_ev << " candidates = " << cands.size()
+            << " undecided = " << n_undecided << " rounds = " << rounds
+            << "\n";
+}
+}  // namespace MIS_dynamic
+
 template <template <class W> class vertex, class W, class Seq>
 inline void verify_MIS(graph<vertex<W>>& GA, Seq& mis) {
   size_t n = GA.n;
@@ -557,7 +557,7 @@ inline edge_array<W> get_top_k(graph<vertex<W>>& G, size_t k, UF& uf,
 template <template <class W> class vertex, class W,
           typename std::enable_if<!std::is_same<W, pbbslib::empty>::value,
                                   int>::type = 0>
-inline void MST(graph<vertex<W>>& GA) {
+inline void MST(graph<vertex<W>>& GA, spec_for_state<uintE>* st = nullptr) {
   using res = reservation<uintE>;
   using edge_t = std::tuple<uintE, uintE, W>;
 
@@ -567,6 +567,9 @@ inline void MST(graph<vertex<W>>& GA) {
 
   auto mst_edges = pbbslib::dyn_arr<edge_t>(n);
 
+  // Round buffers are reused across the speculative_for calls below.
+  spec_for_state<uintE> local;
+  if (st == nullptr) st = &local;
   size_t iter = 0;
   while (GA.m > 0) {
     std::cout << "iter = " << iter << " m = " << GA.m << "\n";
@@ -594,7 +597,7 @@ inline void MST(graph<vertex<W>>& GA) {
         sequence<bool>(n_edges, [](size_t i) { return 0; });
 
     auto UFStep = make_uf_step<uintE>(edges, R, mstFlags, uf);
-    speculative_for<uintE>(UFStep, 0, n_edges, 8);
+    speculative_for<uintE>(UFStep, 0, n_edges, 8, 1, -1, st);
 
     UFStep.clear();
     pbbslib::free_array(R);
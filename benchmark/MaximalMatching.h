@@ -22,6 +22,7 @@
 // SOFTWARE.
 
 #include "bridge.h"
+#include "edge_batch.h"
 #include "ligra.h"
 #include "speculative_for.h"
 
@@ -155,7 +156,7 @@ namespace mm {
 // prefix-based algorithm.
 template <template <class W> class vertex, class W>
 inline sequence<std::tuple<uintE, uintE, W>> MaximalMatching(
-    graph<vertex<W>>& G) {
+    graph<vertex<W>>& G, spec_for_state<uintE>* st = nullptr) {
   using edge = std::tuple<uintE, uintE, W>;
 
   timer mt;
@@ -172,6 +173,9 @@ inline sequence<std::tuple<uintE, uintE, W>> MaximalMatching(
   size_t round = 0;
   timer gete;
   timer eff;
+  // Round buffers are reused across the eff_for calls below.
+  spec_for_state<uintE> local;
+  if (st == nullptr) st = &local;
   while (G.m > 0) {
     gete.start();
     auto e_arr = (round < mm::n_filter_steps)
@@ -186,7 +190,7 @@ inline sequence<std::tuple<uintE, uintE, W>> MaximalMatching(
               << " G.m is now: " << G.m << "\n";
     mm::matchStep<W> mStep(e_arr.E, R.begin(), matched.begin());
     eff.start();
-    eff_for<uintE>(mStep, 0, e_arr.non_zeros, 50, 0, G.n);
+    eff_for<uintE>(mStep, 0, e_arr.non_zeros, 50, 0, G.n, st);
     eff.stop();
 
     auto e_added =
@@ -221,6 +225,187 @@ inline sequence<std::tuple<uintE, uintE, W>> MaximalMatching(
   return std::move(ret);
 }
 
+namespace mm {
+
+// Locally-dominant matching that runs directly on the adjacency lists.
+// prio(u, v, w) gives every edge a priority (it must be symmetric in u and v),
+// and every unmatched vertex keeps a pointer to its highest-priority unmatched
+// neighbor. Each round matches the edges whose endpoints point to each other;
+// a pointer is recomputed only once its target is matched, since the target
+// stays the best choice until then. Only the vertices in frontier take part,
+// so every unmatched neighbor of a frontier vertex must be in frontier too.
+// matched is updated, and the newly matched edges are returned. Apart from
+// O(n) uninitialized space, work is proportional to the degrees of frontier.
+template <template <class W> class vertex, class W, class Prio>
+inline sequence<std::tuple<uintE, uintE, W>> locally_dominant(
+    graph<vertex<W>>& G, bool* matched, Prio& prio, sequence<uintE> frontier) {
+  using edge = std::tuple<uintE, uintE, W>;
+  using P = std::tuple<size_t, uintE, W>;  // (priority, ngh, wgh)
+
+  size_t n = G.n;
+  uintE* best = pbbslib::new_array_no_init<uintE>(n);
+  W* best_wgh = pbbslib::new_array_no_init<W>(n);
+  par_for(0, frontier.size(), pbbslib::kSequentialForThreshold, [&] (size_t i)
+                  { best[frontier[i]] = UINT_E_MAX; });
+
+  // Edges sharing an endpoint are totally ordered by (priority, other
+  // endpoint), which is consistent with a global order on the edges.
+  auto red_f = [](const P& l, const P& r) {
+    if (std::get<1>(l) == UINT_E_MAX) return r;
+    if (std::get<1>(r) == UINT_E_MAX) return l;
+    return (std::make_tuple(std::get<0>(l), std::get<1>(l)) <
+            std::make_tuple(std::get<0>(r), std::get<1>(r))) ? r : l;
+  };
+  auto id = std::make_tuple((size_t)0, UINT_E_MAX, W());
+  auto monoid = pbbslib::make_monoid(red_f, id);
+
+  auto matching = pbbslib::dyn_arr<edge>(frontier.size() / 2 + 1);
+
+  size_t round = 0;
+  while (frontier.size() > 0) {
+    // 1. Recompute pointers whose target was matched in the previous round.
+    par_for(0, frontier.size(), 1, [&] (size_t i) {
+      uintE u = frontier[i];
+      uintE b = best[u];
+      if (b == UINT_E_MAX || matched[b]) {
+        auto map_f = [&](const uintE& src, const uintE& ngh,
+                         const W& wgh) -> P {
+          if (matched[ngh] || ngh == src) return std::make_tuple(0, UINT_E_MAX, wgh);
+          return std::make_tuple(prio(src, ngh, wgh), ngh, wgh);
+        };
+        auto res = G.V[u].template reduceOutNgh<P>(u, map_f, monoid);
+        best[u] = std::get<1>(res);
+        best_wgh[u] = std::get<2>(res);
+      }
+    });
+
+    // 2. Match mutually-pointing pairs.
+    auto is_leader = [&](uintE u) {
+      uintE v = best[u];
+      return v != UINT_E_MAX && u < v && best[v] == u;
+    };
+    auto leaders = pbbslib::filter(frontier, is_leader);
+    auto e_added = sequence<edge>(leaders.size(), [&](size_t i) {
+      uintE u = leaders[i];
+      uintE v = best[u];
+      matched[u] = true;
+      matched[v] = true;
+      return std::make_tuple(u, v, best_wgh[u]);
+    });
+    matching.copyIn(e_added, e_added.size());
+
+    // 3. Vertices with no unmatched neighbor left drop out.
+    frontier = pbbslib::filter(frontier, [&](uintE u) {
+      return !matched[u] && best[u] != UINT_E_MAX;
+    });
+    std::cout << "round = " << round << " matched " << e_added.size()
+              << " edges, frontier size = " << frontier.size() << "\n";
+    round++;
+  }
+  pbbslib::free_array(best);
+  pbbslib::free_array(best_wgh);
+  return sequence<edge>(matching.A, matching.size);
+}
+
+// Extends the matching given by matched (vertices with matched[v] set are
+// skipped) to a maximal one.
+template <template <class W> class vertex, class W, class Prio>
+inline sequence<std::tuple<uintE, uintE, W>> locally_dominant(
+    graph<vertex<W>>& G, bool* matched, Prio& prio) {
+  auto v_im = pbbslib::make_sequence<uintE>(G.n, [](size_t i) { return i; });
+  auto frontier = pbbslib::filter(v_im, [&](uintE v) {
+    return !matched[v] && G.V[v].getOutDegree() > 0;
+  });
+  return locally_dominant(G, matched, prio, std::move(frontier));
+}
+
+}  // namespace mm
+
+// Maximal matching using mm::locally_dominant with random edge priorities.
+// Unlike MaximalMatching this does not materialize or pack edge arrays (O(n)
+// extra memory), and the graph is not mutated.
+template <template <class W> class vertex, class W>
+inline sequence<std::tuple<uintE, uintE, W>> MaximalMatchingLocal(
+    graph<vertex<W>>& G) {
+  timer mt;
+  mt.start();
+  auto r = pbbslib::random();
+  auto matched = sequence<bool>(G.n, [&](size_t i) { return false; });
+  auto prio = [&](const uintE& u, const uintE& v, const W& wgh) {
+    return mm::key_for_pair(u, v, r);
+  };
+  auto matching = mm::locally_dominant(G, matched.begin(), prio);
+  std::cout << "matching size = " << matching.size() << "\n";
+  mt.stop();
+  mt.reportTotal("Matching time");
+  return matching;
+}
+
+namespace mm {
+using edge_batch::pair;
+
+// Repairs a maximal matching of the graph before the batch, given by mate
+// (UINT_E_MAX if unmatched) and matched, into one of G, the graph after
+// inserting ins and deleting del. Deleting a matched edge frees both of its
+// endpoints; the freed vertices and the unmatched endpoints of inserted edges
+// are the only vertices that can have an unmatched neighbor, so
+// locally_dominant runs on them and their unmatched neighbors, with random
+// edge priorities. Work is proportional to the degrees of the affected
+// vertices. mark is scratch space of size n that must be all false (and is
+// left all false).
+template <template <class W> class vertex, class W>
+inline void repair(graph<vertex<W>>& G, sequence<uintE>& mate,
+                   sequence<bool>& matched, sequence<pair>& ins,
+                   sequence<pair>& del, bool* mark, pbbslib::random r) {
+  auto freed_all = sequence<uintE>(2 * del.size(), [&](size_t i) {
+    auto e = del[i / 2];
+    uintE u = std::get<0>(e), v = std::get<1>(e);
+    if (mate[u] != v) return UINT_E_MAX;
+    return (i & 1) ? v : u;
+  });
+  auto freed_f = pbbslib::filter(freed_all,
+                                 [](uintE v) { return v != UINT_E_MAX; });
+  auto freed = edge_batch::unique_vertices(freed_f, mark);
+  par_for(0, freed.size(), pbbslib::kSequentialForThreshold, [&] (size_t i) {
+    mate[freed[i]] = UINT_E_MAX;
+    matched[freed[i]] = false;
+  });
+
+  size_t n_fr = freed.size();
+  auto cands_all = sequence<uintE>(n_fr + 2 * ins.size(), [&](size_t i) {
+    if (i < n_fr) return freed[i];
+    auto e = ins[(i - n_fr) / 2];
+    uintE u = std::get<0>(e), v = std::get<1>(e);
+    if (matched[u] || matched[v]) return UINT_E_MAX;
+    return ((i - n_fr) & 1) ? v : u;
+  });
+  auto cands_f = pbbslib::filter(cands_all,
+                                 [](uintE v) { return v != UINT_E_MAX; });
+  auto cands = edge_batch::unique_vertices(cands_f, mark);
+  auto unmatched = [&](const uintE& w) { return !matched[w]; };
+  auto nghs = edge_batch::neighbors(G, cands, unmatched, mark);
+  auto front_all = sequence<uintE>(cands.size() + nghs.size(), [&](size_t i) {
+    return (i < cands.size()) ? cands[i] : nghs[i - cands.size()];
+  });
+  auto front_u = edge_batch::unique_vertices(front_all, mark);
+  auto frontier = pbbslib::filter(
+      front_u, [&](uintE v) { return G.V[v].getOutDegree() > 0; });
+  size_t n_front = frontier.size();
+
+  auto prio = [&](const uintE& u, const uintE& v, const W& wgh) {
+    return key_for_pair(u, v, r);
+  };
+  auto added = locally_dominant(G, matched.begin(), prio, std::move(frontier));
+  par_for(0, added.size(), pbbslib::kSequentialForThreshold, [&] (size_t i) {
+    uintE u = std::get<0>(added[i]), v = std::get<1>(added[i]);
+    mate[u] = v;
+    mate[v] = u;
+  });
+  std::cout << "freed = " << n_fr << " frontier = " << n_front
+            << " added = " << added.size() << "\n";
+}
+}  // namespace mm
+
 template <template <class W> class vertex, class W, class Seq>
 inline void verify_matching(graph<vertex<W>>& G, Seq& matching) {
   size_t n = G.n;
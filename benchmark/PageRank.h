@@ -24,6 +24,7 @@
 #include "edge_map_reduce.h"
 #include "ligra.h"
 #include "math.h"
+#include "vertex_program.h"
 
 template <template <class W> class vertex, class W>
 struct PR_F {
@@ -114,6 +115,28 @@ void PageRank_edgeMap(graph<vertex<W>>& GA, double eps = 0.000001, size_t max_it
   }
 }
 
+// Vertex program for one PageRank iteration: every vertex sums p_div over
+// its in-neighbors and stores its new rank in p_next.
+struct PR_P {
+  using value_type = double;
+  double* p_div;
+  double* p_next;
+  double damping, addedConstant;
+  pbbslib::addm<double> monoid;
+  PR_P(double* _p_div, double* _p_next, double _damping, double _addedConstant)
+      : p_div(_p_div), p_next(_p_next), damping(_damping),
+        addedConstant(_addedConstant) {}
+  template <class W>
+  inline double gather(const uintE& d, const uintE& s, const W& wgh) {
+    return p_div[s];
+  }
+  inline bool apply(const uintE& v, const double& contribution) {
+    p_next[v] = damping*contribution + addedConstant;
+    return false;
+  }
+  inline bool cond(const uintE& v) { return true; }
+};
+
 template <template <class W> class vertex, class W>
 void PageRank(graph<vertex<W>>& GA, double eps = 0.000001, size_t max_iters = 100) {
   const uintE n = GA.n;
@@ -124,51 +147,37 @@ void PageRank(graph<vertex<W>>& GA, double eps = 0.000001, size_t max_iters = 10
   auto p_curr = pbbs::sequence<double>(n, one_over_n);
   auto p_next = pbbs::sequence<double>(n, static_cast<double>(0));
   auto frontier = pbbs::sequence<bool>(n, true);
-  auto p_div = pbbs::sequence<double>(n, [&] (size_t i) -> double {
-    return one_over_n / static_cast<double>(GA.V[i].getOutDegree());
-  });
 
   // read from special array of just degrees
 
   auto degrees = pbbs::sequence<uintE>(n, [&] (size_t i) { return GA.V[i].getOutDegree(); });
+  auto p_div = pbbs::sequence<double>(n, [&] (size_t i) -> double {
+    return one_over_n / static_cast<double>(degrees[i]);
+  });
 
   vertexSubset Frontier(n,n,frontier.to_array());
-  auto EM = EdgeMap<double, vertex, W>(GA, std::make_tuple(UINT_E_MAX, static_cast<double>(0)), (size_t)GA.m/1000);
-
-  auto cond_f = [&] (const uintE& v) { return true; };
-  auto map_f = [&] (const uintE& d, const uintE& s, const W& wgh) -> double {
-    return p_div[s];
-//    return p_curr[s] / degrees[s];
-  };
-  auto reduce_f = [&] (double l, double r) { return l + r; };
-  auto apply_f = [&] (std::tuple<uintE, double> k) {
-    const uintE& u = std::get<0>(k);
-    const double& contribution = std::get<1>(k);
-    p_next[u] = damping*contribution + addedConstant;
-    p_div[u] = p_next[u]/static_cast<double>(degrees[u]);
-    return Maybe<std::tuple<uintE, double>>();
-  };
+  auto P = PR_P(p_div.begin(), p_next.begin(), damping, addedConstant);
+  auto VP = make_vertex_program(GA, P, no_output);
 
   size_t iter = 0;
   while (iter++ < max_iters) {
     timer t; t.start();
     // SpMV
     timer tt; tt.start();
-    EM.template edgeMapReduce_dense<double, double>(Frontier, cond_f, map_f, reduce_f, apply_f, 0.0, no_output);
+    VP.step(Frontier);
     tt.stop(); tt.reportTotal("em time");
 
-    // Check convergence: compute L1-norm between p_curr and p_next
+    // Check convergence: compute L1-norm between p_curr and p_next, and
+    // compute p_div for the next iteration.
     auto differences = pbbs::delayed_seq<double>(n, [&] (size_t i) {
       auto d = p_curr[i];
-      p_curr[i] = 0;
+      p_curr[i] = p_next[i];
+      p_div[i] = p_next[i]/static_cast<double>(degrees[i]);
       return fabs(d-p_next[i]);
     });
     double L1_norm = pbbs::reduce(differences, pbbs::addm<double>());
     if(L1_norm < eps) break;
     debug(cout << "L1_norm = " << L1_norm << endl;);
-
-    // Reset p_curr
-    std::swap(p_curr,p_next);
     t.stop(); t.reportTotal("iteration time");
   }
   Frontier.del();
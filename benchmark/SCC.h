@@ -31,6 +31,7 @@
 // not necessary, at least on the graphs we tested on).
 //#include "third_party/gbbs/src/chains.h"
 #include "ligra.h"
+#include "union_find.h"
 
 constexpr size_t TOP_BIT = ((size_t)LONG_MAX) + 1;
 constexpr size_t VAL_MASK = LONG_MAX;
@@ -148,6 +149,99 @@ inline pbbslib::resizable_table<K, V, hash_kv> multi_search(graph<vertex<W>>& GA
   return table;
 }
 
+// Bit-parallel variant of Search_F used when a round has few centers. Each
+// vertex owns words consecutive 64-bit words in reach, where bit i is set iff
+// the i'th center of the round reaches the vertex.
+template <class W, class Seq>
+struct Bit_Search_F {
+  Seq& labels;
+  uint64_t* reach;
+  size_t words;
+  bool* bits;
+  Bit_Search_F(Seq& _labels, uint64_t* _reach, size_t _words, bool* _bits)
+      : labels(_labels), reach(_reach), words(_words), bits(_bits) {}
+  inline bool update(const uintE& s, const uintE& d, const W& wgh) {
+    return updateAtomic(s, d, wgh);
+  }
+  inline bool updateAtomic(const uintE& s, const uintE& d, const W& wgh) {
+    if (labels[s] == labels[d]) {
+      bool labels_changed = false;
+      uint64_t* s_reach = reach + s * words;
+      uint64_t* d_reach = reach + d * words;
+      for (size_t k = 0; k < words; k++) {
+        uint64_t s_word = s_reach[k];
+        if (s_word & ~d_reach[k]) {
+          uint64_t old = pbbslib::fetch_and_or(&d_reach[k], s_word);
+          labels_changed |= ((s_word & ~old) != 0);
+        }
+      }
+      if (labels_changed) {
+        return pbbslib::CAS(&bits[d], false, true);
+      }
+    }
+    return false;
+  }
+
+  inline bool cond(uintE d) { return !(labels[d] & TOP_BIT); }
+};
+
+template <class W, class Seq>
+inline Bit_Search_F<W, Seq> make_bit_search_f(Seq& labels, uint64_t* reach,
+                                               size_t words, bool* bits) {
+  return Bit_Search_F<W, Seq>(labels, reach, words, bits);
+}
+
+// Runs a multi-source search from the (at most 64 * words) vertices in
+// frontier, setting bit i of the reach words of every vertex reached from the
+// i'th center. Returns every vertex whose reach words were modified (possibly
+// with duplicates), so that the caller can read and reset them.
+template <template <class W> class vertex, class W, class Seq, class VS>
+inline sequence<uintE> multi_search_bits(graph<vertex<W>>& GA, Seq& labels,
+                                         bool* bits, uint64_t* reach,
+                                         size_t words, VS& frontier,
+                                         const flags fl = 0) {
+  frontier.toSparse();
+  par_for(0, frontier.size(), pbbslib::kSequentialForThreshold, [&] (size_t i) {
+    uintE v = frontier.vtx(i);
+    reach[v * words + i / 64] |= ((uint64_t)1) << (i % 64);
+  });
+
+  std::vector<sequence<uintE>> visited;
+  size_t rd = 0;
+  while (!frontier.isEmpty()) {
+    frontier.toSparse();
+    visited.emplace_back(sequence<uintE>(
+        frontier.size(), [&](size_t i) { return frontier.vtx(i); }));
+
+    par_for(0, frontier.size(), [&] (size_t i) {
+      uintE v = frontier.s[i];
+      bits[v] = 0;  // reset flag
+    }, (frontier.size() > 2000));
+
+    vertexSubset output =
+        edgeMap(GA, frontier, make_bit_search_f<W>(labels, reach, words, bits),
+                -1, fl | no_dense);
+    frontier.del();
+    frontier = output;
+    rd++;
+  }
+
+  auto offs = sequence<size_t>(visited.size() + 1);
+  for (size_t i = 0; i < visited.size(); i++) {
+    offs[i] = visited[i].size();
+  }
+  offs[visited.size()] = 0;
+  size_t total = pbbslib::scan_add_inplace(offs);
+  auto all = sequence<uintE>(total);
+  par_for(0, visited.size(), 1, [&] (size_t i) {
+    size_t off = offs[i];
+    auto& vis = visited[i];
+    par_for(0, vis.size(), pbbslib::kSequentialForThreshold, [&] (size_t j)
+                    { all[off + j] = vis[j]; });
+  });
+  return all;
+}
+
 template <class V, class L>
 struct First_Search {
   V& visited;
@@ -188,8 +282,206 @@ inline bool* first_search(graph<vertex<W>>& GA, L& labels, uintE start,
   return Flags.to_array();
 }
 
+// Decrements the live degree of d for every live edge (s, d) in the
+// subproblem. d is returned (exactly once) when its degree reaches zero.
+template <class W, class Seq>
+struct Trim_F {
+  Seq& labels;
+  intE* deg;
+  bool* flags;
+  Trim_F(Seq& _labels, intE* _deg, bool* _flags)
+      : labels(_labels), deg(_deg), flags(_flags) {}
+  inline bool update(const uintE& s, const uintE& d, const W& wgh) {
+    return updateAtomic(s, d, wgh);
+  }
+  inline bool updateAtomic(const uintE& s, const uintE& d, const W& wgh) {
+    if (labels[s] == labels[d] && pbbslib::fetch_and_add(&deg[d], -1) == 1) {
+      return pbbslib::CAS(&flags[d], false, true);
+    }
+    return false;
+  }
+  inline bool cond(uintE d) { return !(labels[d] & TOP_BIT) && !flags[d]; }
+};
+
+template <class W, class Seq>
+inline Trim_F<W, Seq> make_trim_f(Seq& labels, intE* deg, bool* flags) {
+  return Trim_F<W, Seq>(labels, deg, flags);
+}
+
+// Iteratively removes vertices with no live in- or out-edges inside their
+// subproblem. Each removed vertex is a singleton SCC and receives a fresh
+// label from label_offset. Returns the number of vertices removed.
+template <template <class W> class vertex, class W, class Seq>
+inline size_t trim_singletons(graph<vertex<W>>& GA, Seq& labels,
+                              size_t& label_offset) {
+  size_t n = GA.n;
+  auto live_pred = [&](const uintE& src, const uintE& ngh, const W& wgh) {
+    return labels[src] == labels[ngh];
+  };
+  auto in_deg = sequence<intE>(n);
+  auto out_deg = sequence<intE>(n);
+  auto flags = sequence<bool>(n);
+  par_for(0, n, 1, [&] (size_t i) {
+    if (labels[i] & TOP_BIT) {
+      in_deg[i] = 0;
+      out_deg[i] = 0;
+      flags[i] = false;
+    } else {
+      in_deg[i] = GA.V[i].countInNgh(i, live_pred);
+      out_deg[i] = GA.V[i].countOutNgh(i, live_pred);
+      flags[i] = (in_deg[i] == 0) || (out_deg[i] == 0);
+    }
+  });
+  auto v_im = pbbslib::make_sequence<uintE>(n, [](size_t i) { return i; });
+  auto init = pbbslib::filter(v_im, [&](uintE v) { return flags[v]; });
+  size_t init_size = init.size();
+  auto frontier = vertexSubset(n, init_size, init.to_array());
+
+  size_t removed = 0, rd = 0;
+  while (!frontier.isEmpty()) {
+    removed += frontier.size();
+    // Frontier vertices still carry their subproblem label here, so both maps
+    // only decrement degrees along edges internal to the subproblem.
+    auto out_nghs = edgeMap(
+        GA, frontier, make_trim_f<W>(labels, in_deg.begin(), flags.begin()));
+    auto in_nghs =
+        edgeMap(GA, frontier,
+                make_trim_f<W>(labels, out_deg.begin(), flags.begin()), -1,
+                in_edges);
+
+    frontier.toSparse();
+    size_t offset = label_offset;
+    par_for(0, frontier.size(), pbbslib::kSequentialForThreshold, [&] (size_t i)
+                    { labels[frontier.vtx(i)] = (offset + i) | TOP_BIT; });
+    label_offset += frontier.size();
+
+    // flags ensures the two outputs are disjoint.
+    out_nghs.toSparse();
+    in_nghs.toSparse();
+    size_t out_size = out_nghs.size(), in_size = in_nghs.size();
+    auto next = sequence<uintE>(out_size + in_size, [&](size_t i) {
+      return (i < out_size) ? out_nghs.vtx(i) : in_nghs.vtx(i - out_size);
+    });
+    out_nghs.del();
+    in_nghs.del();
+    frontier.del();
+    frontier = vertexSubset(n, next.size(), next.to_array());
+    rd++;
+  }
+  std::cout << "trim: removed " << removed << " vertices in " << rd
+            << " rounds"
+            << "\n";
+  return removed;
+}
+
+// Finds SCCs {u, v} where u and v are each other's only live out-neighbor
+// (or only live in-neighbor, if fl contains in_edges) inside their subproblem.
+// Such pairs are not handled by trim_singletons. Returns the number of pairs.
+template <template <class W> class vertex, class W, class Seq>
+inline size_t trim_pairs(graph<vertex<W>>& GA, Seq& labels,
+                         size_t& label_offset, const flags fl = 0) {
+  using D = std::tuple<uintE, uintE>;  // (#live nghs, min live ngh)
+  size_t n = GA.n;
+  auto map_f = [&](const uintE& src, const uintE& ngh, const W& wgh) -> D {
+    if (labels[src] == labels[ngh]) return std::make_tuple(1, ngh);
+    return std::make_tuple(0, UINT_E_MAX);
+  };
+  auto red_f = [](const D& l, const D& r) {
+    return std::make_tuple(std::get<0>(l) + std::get<0>(r),
+                           std::min(std::get<1>(l), std::get<1>(r)));
+  };
+  auto monoid = pbbslib::make_monoid(red_f, std::make_tuple(0, UINT_E_MAX));
+  auto nghs = sequence<D>(n);
+  par_for(0, n, 1, [&] (size_t i) {
+    if (labels[i] & TOP_BIT) {
+      nghs[i] = std::make_tuple(0, UINT_E_MAX);
+    } else {
+      nghs[i] = (fl & in_edges)
+                    ? GA.V[i].template reduceInNgh<D>(i, map_f, monoid)
+                    : GA.V[i].template reduceOutNgh<D>(i, map_f, monoid);
+    }
+  });
+  auto is_leader = [&](uintE u) {
+    if (std::get<0>(nghs[u]) != 1) return false;
+    uintE v = std::get<1>(nghs[u]);
+    return u < v && std::get<0>(nghs[v]) == 1 && std::get<1>(nghs[v]) == u;
+  };
+  auto v_im = pbbslib::make_sequence<uintE>(n, [](size_t i) { return i; });
+  auto leaders = pbbslib::filter(v_im, is_leader);
+  size_t offset = label_offset;
+  par_for(0, leaders.size(), pbbslib::kSequentialForThreshold, [&] (size_t i) {
+    uintE u = leaders[i];
+    uintE v = std::get<1>(nghs[u]);
+    labels[u] = (offset + i) | TOP_BIT;
+    labels[v] = (offset + i) | TOP_BIT;
+  });
+  label_offset += leaders.size();
+  return leaders.size();
+}
+
+// Splits every subproblem into its weakly connected components (restricted to
+// live edges inside the subproblem) and gives each component a fresh label.
+// Returns the number of components.
+template <template <class W> class vertex, class W, class Seq>
+inline size_t wcc_subproblems(graph<vertex<W>>& GA, Seq& labels,
+                              size_t& label_offset) {
+  size_t n = GA.n;
+  auto parents = sequence<uintE>(n, [](size_t i) { return i; });
+  par_for(0, n, 1, [&] (size_t i) {
+    if (!(labels[i] & TOP_BIT)) {
+      auto map_f = [&](const uintE& src, const uintE& ngh, const W& wgh) {
+        if (labels[src] == labels[ngh]) {
+          union_find::unite(src, ngh, parents.begin());
+        }
+      };
+      GA.V[i].mapOutNgh(i, map_f);
+    }
+  });
+  auto roots = sequence<uintE>(n + 1);
+  par_for(0, n, pbbslib::kSequentialForThreshold, [&] (size_t i) {
+    roots[i] = !(labels[i] & TOP_BIT) &&
+               (union_find::find_compress<uintE>(i, parents.begin()) == i);
+  });
+  roots[n] = 0;
+  size_t num_components = pbbslib::scan_add_inplace(roots);
+  size_t offset = label_offset;
+  par_for(0, n, pbbslib::kSequentialForThreshold, [&] (size_t i) {
+    if (!(labels[i] & TOP_BIT)) {
+      uintE root = union_find::find_compress<uintE>(i, parents.begin());
+      labels[i] = offset + roots[root];
+    }
+  });
+  label_offset += num_components;
+  return num_components;
+}
+
+// Resolves the SCCs that do not require reachability searches: iterated
+// trimming of singleton and size-two SCCs, followed by splitting the remaining
+// subproblems into weakly connected components.
+template <template <class W> class vertex, class W, class Seq>
+inline void trim_and_partition(graph<vertex<W>>& GA, Seq& labels,
+                               size_t& label_offset) {
+  timer tt;
+  tt.start();
+  trim_singletons(GA, labels, label_offset);
+  size_t pairs = trim_pairs(GA, labels, label_offset);
+  pairs += trim_pairs(GA, labels, label_offset, in_edges);
+  std::cout << "trim: found " << pairs << " size-two sccs"
+            << "\n";
+  if (pairs > 0) {
+    trim_singletons(GA, labels, label_offset);
+  }
+  size_t num_components = wcc_subproblems(GA, labels, label_offset);
+  std::cout << "trim: " << num_components << " weakly connected subproblems"
+            << "\n";
+  tt.stop();
+  tt.reportTotal("trim time");
+}
+
 template <class vertex>
-inline sequence<label_type> SCC(graph<vertex>& GA, double beta = 1.1) {
+inline sequence<label_type> SCC(graph<vertex>& GA, double beta = 1.1,
+                                bool trim = true,
+                                size_t max_bit_centers = 64) {
   timer initt;
   initt.start();
   size_t n = GA.n;
@@ -198,6 +490,16 @@ inline sequence<label_type> SCC(graph<vertex>& GA, double beta = 1.1) {
   auto ba = sequence<bool>(n, false);
   auto bits = ba.to_array();
 
+  // Reachability words used by rounds with at most max_bit_centers centers;
+  // only allocated when bit-parallel rounds are enabled.
+  size_t max_words = (max_bit_centers + 63) / 64;
+  auto in_reach = sequence<uint64_t>();
+  auto out_reach = sequence<uint64_t>();
+  if (max_bit_centers > 0) {
+    in_reach = sequence<uint64_t>(n * max_words, (uint64_t)0);
+    out_reach = sequence<uint64_t>(n * max_words, (uint64_t)0);
+  }
+
   auto v_im_f = [](size_t i) { return i; };
   auto v_im = pbbslib::make_sequence<uintE>(n, v_im_f);
   auto zero_pred = [&](size_t i) {
@@ -260,6 +562,10 @@ inline sequence<label_type> SCC(graph<vertex>& GA, double beta = 1.1) {
     }
   }
 
+  if (trim) {
+    trim_and_partition(GA, labels, label_offset);
+  }
+
   auto Q = pbbslib::filter(P, [&](uintE v) { return !(labels[v] & TOP_BIT); });
   std::cout << "After first round, Q = " << Q.size()
             << " vertices remain. Total done = " << (n - Q.size()) << "\n";
@@ -317,6 +623,63 @@ inline sequence<label_type> SCC(graph<vertex>& GA, double beta = 1.1) {
       continue;
     }
 
+    if (max_bit_centers > 0 && centers.size() <= max_bit_centers) {
+      timer bs; bs.start();
+      size_t centers_size = centers.size();
+      size_t words = (centers_size + 63) / 64;
+      auto centers_2 = centers;
+      auto in_f = vertexSubset(n, centers_size, centers.to_array());
+      auto in_visited = multi_search_bits(GA, labels, bits, in_reach.begin(),
+                                          words, in_f, in_edges);
+      auto out_f = vertexSubset(n, centers_size, centers_2.to_array());
+      auto out_visited = multi_search_bits(GA, labels, bits, out_reach.begin(),
+                                           words, out_f);
+      bs.stop(); bs.reportTotal("bit search time");
+
+      // The largest center reaching v in both directions acquires v;
+      // otherwise v joins the subproblem of the largest center reaching it.
+      auto label_f = [&](uintE v) {
+        uint64_t* in_v = in_reach.begin() + v * words;
+        uint64_t* out_v = out_reach.begin() + v * words;
+        for (size_t k = words; k > 0; k--) {
+          uint64_t both = in_v[k - 1] & out_v[k - 1];
+          if (both) {
+            size_t label = cur_label_offset + 64 * (k - 1) + 63 -
+                           __builtin_clzll(both);
+            pbbslib::write_max(&labels[v], label | TOP_BIT);
+            return;
+          }
+        }
+        for (size_t k = words; k > 0; k--) {
+          uint64_t either = in_v[k - 1] | out_v[k - 1];
+          if (either) {
+            size_t label = cur_label_offset + 64 * (k - 1) + 63 -
+                           __builtin_clzll(either);
+            pbbslib::write_max(&labels[v], label);
+            return;
+          }
+        }
+      };
+      par_for(0, in_visited.size(), pbbslib::kSequentialForThreshold,
+              [&] (size_t i) { label_f(in_visited[i]); });
+      par_for(0, out_visited.size(), pbbslib::kSequentialForThreshold,
+              [&] (size_t i) { label_f(out_visited[i]); });
+
+      auto clear_f = [&](uintE v) {
+        for (size_t k = 0; k < words; k++) {
+          in_reach[v * words + k] = 0;
+          out_reach[v * words + k] = 0;
+        }
+      };
+      par_for(0, in_visited.size(), pbbslib::kSequentialForThreshold,
+              [&] (size_t i) { clear_f(in_visited[i]); });
+      par_for(0, out_visited.size(), pbbslib::kSequentialForThreshold,
+              [&] (size_t i) { clear_f(out_visited[i]); });
+      rt.stop();
+      rt.reportTotal("Round time");
+      continue;
+    }
+
     timer ins; ins.start();
     auto centers_2 = centers;
     size_t centers_size = centers.size();
@@ -383,10 +746,20 @@ inline size_t num_done(Seq& labels) {
   return pbbslib::reduce_add(im);
 }
 
+// Labels are not necessarily smaller than n, since labels are also consumed
+// by trimming and subproblem splits.
+template <class Seq>
+inline size_t max_label(Seq& labels) {
+  auto im = pbbslib::make_sequence<size_t>(
+      labels.size(), [&](size_t i) { return labels[i] & VAL_MASK; });
+  return pbbslib::reduce_max(im);
+}
+
 template <class Seq>
 inline size_t num_scc(Seq& labels) {
   size_t n = labels.size();
-  auto flags = sequence<uintE>(n + 1, [&](size_t i) { return 0; });
+  size_t num_labels = max_label(labels) + 1;
+  auto flags = sequence<uintE>(num_labels + 1, [&](size_t i) { return 0; });
   par_for(0, n, pbbslib::kSequentialForThreshold, [&] (size_t i) {
     if (labels[i] == 0) {
       std::cout << "unlabeled"
@@ -399,15 +772,16 @@ inline size_t num_scc(Seq& labels) {
     }
   });
   pbbslib::scan_add_inplace(flags);
-  size_t n_scc = flags[n];
-  std::cout << "n_scc = " << flags[n] << "\n";
+  size_t n_scc = flags[num_labels];
+  std::cout << "n_scc = " << n_scc << "\n";
   return n_scc;
 }
 
 template <class Seq>
 inline void scc_stats(Seq& labels) {
   size_t n = labels.size();
-  auto flags = sequence<uintE>(n + 1, [&](size_t i) { return 0; });
+  size_t num_labels = max_label(labels) + 1;
+  auto flags = sequence<uintE>(num_labels, [&](size_t i) { return 0; });
   for (size_t i = 0; i < n; i++) {
     size_t label = labels[i] & VAL_MASK;
     flags[label]++;
@@ -415,7 +789,7 @@ inline void scc_stats(Seq& labels) {
   size_t maxv = pbbslib::reduce_max(flags);
   std::cout << "Largest SCC has " << maxv << " vertices"
             << "\n";
-  for (size_t i = 0; i < n; i++) {
+  for (size_t i = 0; i < num_labels; i++) {
     if (flags[i] == maxv) {
       std::cout << "max flag = " << i << "\n";
     }
@@ -0,0 +1,228 @@
+// This code is part of the project "Theoretically Efficient Parallel Graph
+// Algorithms Can Be Fast and Scalable", presented at Symposium on Parallelism
+// in Algorithms and Architectures, 2018.
+// Copyright (c) 2018 Laxman Dhulipala, Guy Blelloch, and Julian Shun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all  copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Graph sampling. Every sampler returns a new symmetric, uncompressed graph
+// built in parallel from the kept edges with sample_edges and
+// sym_graph_from_edges; the input may be compressed. Edge samplers keep the
+// vertex set, and vertex samplers return the subgraph induced by the sampled
+// vertices, relabeled to 0..n'-1 in the order of their original ids. All
+// randomness is derived from the seed by hashing, so a sample is reproducible
+// and an edge sampler makes the same decision for (u, v) and (v, u).
+
+#pragma once
+
+#include <type_traits>
+
+#include "ligra.h"
+
+namespace sampling {
+
+// A uniform value in [0, 1) determined by key and salt.
+inline double coin(uint64_t key, uint64_t salt) {
+  uint64_t h = pbbslib::hash64_2(key ^ pbbslib::hash64(salt));
+  return (h >> 11) * (1.0 / (((uint64_t)1) << 53));
+}
+
+// A coin shared by both directions of the edge {u, v}.
+inline double edge_coin(uintE u, uintE v, size_t seed) {
+  uint64_t l = std::min(u, v), r = std::max(u, v);
+  return coin((l << 32) + r, seed);
+}
+
+// Builds the symmetric graph on the same vertices made of the edges satisfying
+// pred, which must be symmetric.
+template <template <class W> class vertex, class W, class P>
+inline graph<symmetricVertex<W>> sample_graph(graph<vertex<W>>& G, P& pred) {
+  auto EA = sample_edges(G, pred);
+  // sample_edges emits the edges grouped by source.
+  auto GS = sym_graph_from_edges<W>(EA, true);
+  EA.del();
+  return GS;
+}
+
+// Returns the subgraph induced by the vertices v with keep[v], relabeled.
+template <template <class W> class vertex, class W, class Seq>
+inline graph<symmetricVertex<W>> InducedSubgraph(graph<vertex<W>>& G,
+                                                 Seq& keep) {
+  size_t n = G.n;
+  auto ids = sequence<uintE>(n, [&] (size_t i) { return (uintE)keep[i]; });
+  size_t n_new = pbbslib::scan_add_inplace(ids);
+  auto pred = [&](const uintE& u, const uintE& v, const W& w) {
+    return keep[u] && keep[v];
+  };
+  auto EA = sample_edges(G, pred);
+  // Relabeling preserves the order, so the edges stay grouped by source.
+  par_for(0, EA.non_zeros, pbbslib::kSequentialForThreshold, [&] (size_t i) {
+    auto& e = EA.E[i];
+    e = std::make_tuple(ids[std::get<0>(e)], ids[std::get<1>(e)],
+                        std::get<2>(e));
+  });
+  EA.num_rows = n_new;
+  EA.num_cols = n_new;
+  auto GS = sym_graph_from_edges<W>(EA, true);
+  EA.del();
+  return GS;
+}
+
+// Keeps every edge independently with probability p.
+template <template <class W> class vertex, class W>
+inline graph<symmetricVertex<W>> UniformEdgeSample(graph<vertex<W>>& G,
+                                                   double p, size_t seed = 0) {
+  auto pred = [&](const uintE& u, const uintE& v, const W& w) {
+    return edge_coin(u, v, seed) < p;
+  };
+  return sample_graph(G, pred);
+}
+
+// Importance sampling in the style of spectral sparsification, with the
+// effective resistance of {u, v} replaced by the degree-based estimate
+// 1/d(u) + 1/d(v): edge {u, v} is kept with probability
+// min(1, q (1/d(u) + 1/d(v))). The estimates sum to the number of non-isolated
+// vertices, which sets q so that about a fraction p of the edges is kept.
+// Edges into low-degree vertices, which carry most of the connectivity, are
+// therefore kept more often than edges between hubs. On weighted graphs a
+// kept edge's weight is divided by its probability, so that the expected
+// weight of every cut is preserved (up to rounding).
+template <template <class W> class vertex, class W>
+inline graph<symmetricVertex<W>> ImportanceEdgeSample(graph<vertex<W>>& G,
+                                                      double p,
+                                                      size_t seed = 0) {
+  size_t n = G.n;
+  auto non_isolated = pbbslib::make_sequence<size_t>(n, [&] (size_t i) {
+    return static_cast<size_t>(G.V[i].getOutDegree() > 0);
+  });
+  size_t n_ni = pbbslib::reduce_add(non_isolated);
+  double q = (n_ni == 0) ? 0.0 : p * (G.m / 2.0) / n_ni;
+  auto prob = [&](const uintE& u, const uintE& v) {
+    double r = 1.0 / G.V[u].getOutDegree() + 1.0 / G.V[v].getOutDegree();
+    return std::min(1.0, q * r);
+  };
+  auto pred = [&](const uintE& u, const uintE& v, const W& w) {
+    return edge_coin(u, v, seed) < prob(u, v);
+  };
+  auto EA = sample_edges(G, pred);
+  if constexpr (std::is_arithmetic<W>::value) {
+    par_for(0, EA.non_zeros, pbbslib::kSequentialForThreshold, [&] (size_t i) {
+      auto& e = EA.E[i];
+      double w = std::get<2>(e) / prob(std::get<0>(e), std::get<1>(e));
+      std::get<2>(e) = std::max<W>(1, static_cast<W>(std::round(w)));
+    });
+  }
+  auto GS = sym_graph_from_edges<W>(EA, true);
+  EA.del();
+  return GS;
+}
+
+template <class W>
+struct Burn_F {
+  bool* burned;
+  double p;
+  uint64_t salt;
+  Burn_F(bool* _burned, double _p, uint64_t _salt)
+      : burned(_burned), p(_p), salt(_salt) {}
+  inline bool spreads(const uintE& s, const uintE& d) {
+    return coin((((uint64_t)s) << 32) + d, salt) < p;
+  }
+  inline bool update(const uintE& s, const uintE& d, const W& w) {
+    if (spreads(s, d)) {
+      burned[d] = true;
+      return true;
+    }
+    return false;
+  }
+  inline bool updateAtomic(const uintE& s, const uintE& d, const W& w) {
+    return spreads(s, d) && pbbslib::CAS(&burned[d], false, true);
+  }
+  inline bool cond(const uintE& d) { return !burned[d]; }
+};
+
+// Forest-fire vertex sampling: a burning vertex sets each of its unburned
+// neighbors on fire independently with probability p, and new fires are lit
+// at random vertices whenever all fires have died out. To keep the number of
+// rounds small, a batch of fires proportional to the number of vertices still
+// needed is lit at once. Returns a flag per vertex; at least num_vertices
+// (at most n) vertices are burned, as the last round may overshoot.
+template <template <class W> class vertex, class W>
+inline sequence<bool> ForestFireVertices(graph<vertex<W>>& G,
+                                         size_t num_vertices, double p,
+                                         size_t seed = 0) {
+  size_t n = G.n;
+  size_t target = std::min(num_vertices, n);
+  auto burned = sequence<bool>(n, false);
+  auto r = pbbslib::random(seed);
+  size_t num_burned = 0, num_lit = 0, round = 0;
+  vertexSubset frontier(n);
+  while (num_burned < target) {
+    if (frontier.isEmpty()) {
+      size_t k = 1 + (target - num_burned) / 64;
+      auto lit = sequence<bool>(k);
+      auto cands = sequence<uintE>(k, [&] (size_t i) {
+        uintE v = r.ith_rand(num_lit + i) % n;
+        lit[i] = pbbslib::CAS(&burned[v], false, true);
+        return v;
+      });
+      num_lit += k;
+      auto fires = pbbslib::pack(cands, lit);
+      size_t num_fires = fires.size();
+      frontier.del();
+      frontier = vertexSubset(n, num_fires, fires.to_array());
+    } else {
+      auto burn_f = Burn_F<W>(burned.begin(), p, seed + round);
+      auto next = edgeMap(G, frontier, burn_f, -1, sparse_blocked);
+      frontier.del();
+      frontier = next;
+      round++;
+    }
+    num_burned += frontier.size();
+  }
+  frontier.del();
+  debug(cout << "burned = " << num_burned << " fires lit = " << num_lit
+             << " rounds = " << round << endl;);
+  return burned;
+}
+
+// Random-walk vertex sampling: num_walks walks of walk_length steps start at
+// random vertices, and every vertex a walk visits is sampled.
+template <template <class W> class vertex, class W>
+inline sequence<bool> RandomWalkVertices(graph<vertex<W>>& G,
+                                         size_t num_walks, size_t walk_length,
+                                         size_t seed = 0) {
+  size_t n = G.n;
+  auto visited = sequence<bool>(n, false);
+  if (n == 0) return visited;
+  auto r = pbbslib::random(seed);
+  par_for(0, num_walks, 1, [&] (size_t i) {
+    size_t o = i * (walk_length + 1);
+    uintE v = r.ith_rand(o) % n;
+    visited[v] = true;
+    for (size_t t = 1; t <= walk_length; t++) {
+      uintE d = G.V[v].getOutDegree();
+      if (d == 0) break;
+      v = std::get<0>(G.V[v].get_ith_out_neighbor(v, r.ith_rand(o + t) % d));
+      if (!visited[v]) visited[v] = true;
+    }
+  });
+  return visited;
+}
+
+}  // namespace sampling
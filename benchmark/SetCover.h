@@ -132,7 +132,7 @@ inline pbbslib::dyn_arr<uintE> SetCover(graph<vertex<W>>& G, size_t num_buckets
             no_output | dense_forward);
 
     // 3. sets -> elements (count and add to cover if enough elms were won)
-    const size_t low_threshold =
+    const size_t low_threshold = (cur_bkt == 0) ? 1 :
         std::max((size_t)ceil(pow(1.0 + sc::epsilon, cur_bkt - 1)), (size_t)1);
     auto won_ngh_f = [&](const uintE& u, const uintE& v, const W& wgh) -> bool {
       return Elms[v] == perm[u];
@@ -201,3 +201,157 @@ inline pbbslib::dyn_arr<uintE> SetCover(graph<vertex<W>>& G, size_t num_buckets
   std::cout << "Num_uncovered = " << (G.n - elms_cov) << "\n";
   return cover;
 }
+
+// Same algorithm as SetCover, but each round makes two traversals over the
+// edges of the bucket's sets instead of four:
+//   1. Each set packs out its covered elements and, if its new degree is
+//      still above the threshold, immediately reserves its remaining
+//      elements (write_min of its priority) while the packed list is in cache.
+//      Priorities are a random permutation of the whole bucket, which is known
+//      before packing.
+//   2. Each remaining set scans its elements once, appending the ones it won
+//      to its slice of a buffer using a per-set counter. It then joins the
+//      cover if it won enough, and marks its won elements covered or
+//      releases them by walking the buffer instead of the adjacency list.
+// Elements are only ever written by the set that won them, so the counting
+// and the release/cover writes of different sets can be interleaved.
+template <template <class W> class vertex, class W>
+inline pbbslib::dyn_arr<uintE> SetCoverFused(graph<vertex<W>>& G,
+                                             size_t num_buckets = 512) {
+  timer it; it.start();
+  auto Elms = sequence<uintE>(G.n, [&](size_t i) { return UINT_E_MAX; });
+  auto get_bucket_clamped = [&](size_t deg) -> uintE {
+    return (deg == 0) ? UINT_E_MAX : (uintE)floor(sc::x * log((double)deg));
+  };
+  auto D = sequence<uintE>(G.n, [&](size_t i) { return get_bucket_clamped(G.V[i].getOutDegree()); });
+  auto d_slice = D.slice();
+  auto b = make_vertex_buckets(G.n, d_slice, decreasing, num_buckets);
+
+  auto perm = sequence<uintE>(G.n);
+  timer bktt, permt, packt, wont;
+
+  timer nbt;
+  size_t rounds = 0;
+  pbbslib::dyn_arr<uintE> cover = pbbslib::dyn_arr<uintE>();
+  auto r = pbbslib::random();
+  it.stop(); it.reportTotal("initialization time");
+  while (true) {
+    nbt.start();
+    auto bkt = b.next_bucket();
+    auto active = vertexSubset(G.n, bkt.identifiers);
+    size_t cur_bkt = bkt.id;
+    if (cur_bkt == b.null_bkt) {
+      break;
+    }
+    nbt.stop();
+    active.toSparse();
+    size_t na = active.size();
+
+    permt.start();
+    auto P = pbbslib::random_permutation<uintE>(na, r);
+    par_for(0, na, pbbslib::kSequentialForThreshold, [&] (size_t i) {
+                      perm[active.vtx(i)] = P[i];
+                    });
+    P.clear();
+    permt.stop();
+
+    packt.start();
+    // 1. sets -> elements (pack out covered elements, update the degree, and
+    // reserve the remaining elements if the set is still above threshold)
+    size_t threshold = ceil(pow(1.0 + sc::epsilon, cur_bkt));
+    auto pack_predicate = [&](const uintE& u, const uintE& ngh, const W& wgh) {
+      return Elms[ngh] != sc::COVERED;
+    };
+    auto visit_f = [&](const uintE& u, const uintE& ngh, const W& wgh) {
+      if (Elms[ngh] != sc::COVERED) {
+        pbbslib::write_min(&Elms[ngh], perm[u]);
+      }
+    };
+    auto space = sequence<uintT>(na, [&](size_t i) {
+      return (uintT)G.V[active.vtx(i)].calculateOutTemporarySpace();
+    });
+    size_t total_space = pbbslib::scan_add_inplace(space);
+    auto tmp = sequence<std::tuple<uintE, W>>(total_space);
+    auto above = sequence<bool>(na);
+    par_for(0, na, 1, [&] (size_t i) {
+      uintE v = active.vtx(i);
+      size_t ct = G.V[v].packOutNgh(v, pack_predicate, tmp.begin() + space[i]);
+      D[v] = get_bucket_clamped(ct);
+      above[i] = (ct >= threshold);
+      if (above[i]) {
+        G.V[v].mapOutNgh(v, visit_f);
+      }
+    });
+    auto active_im = pbbslib::make_sequence<uintE>(
+        na, [&](size_t i) { return active.vtx(i); });
+    auto still_active = pbbslib::pack(active_im, above);
+    packt.stop();
+
+    debug(std::cout << "Round = " << rounds << " bkt = " << cur_bkt
+              << " active = " << na
+              << " stillactive = " << still_active.size() << "\n";);
+
+    wont.start();
+    // 2. sets -> elements (count won elements, then cover or release them)
+    const size_t low_threshold = (cur_bkt == 0) ? 1 :
+        std::max((size_t)ceil(pow(1.0 + sc::epsilon, cur_bkt - 1)), (size_t)1);
+    size_t ns = still_active.size();
+    auto offs = sequence<size_t>(ns, [&](size_t i) {
+      return (size_t)G.V[still_active[i]].getOutDegree();
+    });
+    size_t total_won = pbbslib::scan_add_inplace(offs);
+    auto won = sequence<uintE>(total_won);
+    auto num_won = sequence<uintE>(ns, [](size_t i) { return 0; });
+    par_for(0, ns, 1, [&] (size_t i) {
+      uintE u = still_active[i];
+      uintE* won_u = won.begin() + offs[i];
+      auto won_f = [&](const uintE& src, const uintE& ngh, const W& wgh) {
+        if (Elms[ngh] == perm[src]) {
+          won_u[pbbslib::fetch_and_add(&num_won[i], (uintE)1)] = ngh;
+        }
+      };
+      G.V[u].mapOutNgh(u, won_f);
+      size_t k = num_won[i];
+      bool joins = (k >= low_threshold);
+      if (joins) D[u] = UINT_E_MAX;
+      uintE val = joins ? sc::COVERED : UINT_E_MAX;
+      par_for(0, k, pbbslib::kSequentialForThreshold, [&] (size_t j)
+                      { Elms[won_u[j]] = val; });
+    });
+    auto in_cover = pbbslib::filter(
+        still_active, [&](uintE v) { return D[v] == UINT_E_MAX; });
+    cover.copyInF([&](uintE i) { return in_cover[i]; }, in_cover.size());
+    wont.stop();
+
+    bktt.start();
+    // Rebucket the active sets. Ignore those that joined the cover.
+    auto f = [&](size_t i) -> Maybe<std::tuple<uintE, uintE>> {
+      const uintE v = active.vtx(i);
+      const uintE v_bkt = D[v];
+      uintE bkt = UINT_E_MAX;
+      if (!(v_bkt == UINT_E_MAX))
+        bkt = b.get_bucket(v_bkt);
+      return Maybe<std::tuple<uintE, uintE>>(std::make_tuple(v, bkt));
+    };
+    b.update_buckets(f, na);
+    active.del();
+    rounds++;
+    bktt.stop();
+    r = r.next();
+  }
+  b.del();
+
+  bktt.reportTotal("bucket");
+  nbt.reportTotal("next bucket time");
+  permt.reportTotal("perm");
+  packt.reportTotal("pack and reserve");
+  wont.reportTotal("count and resolve");
+  auto elm_cov_f = [&](uintE v) { return (uintE)(Elms[v] == sc::COVERED); };
+  auto elm_cov = pbbslib::make_sequence<uintE>(G.n, elm_cov_f);
+  size_t elms_cov = pbbslib::reduce_add(elm_cov);
+  std::cout << "|V| = " << G.n << " |E| = " << G.m << "\n";
+  std::cout << "|cover|: " << cover.size << "\n";
+  std::cout << "Rounds: " << rounds << "\n";
+  std::cout << "Num_uncovered = " << (G.n - elms_cov) << "\n";
+  return cover;
+}
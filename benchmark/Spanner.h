@@ -23,9 +23,13 @@
 
 #pragma once
 
+#include <type_traits>
+
+#include "Eccentricity.h"
 #include "LDD.h"
 #include "pbbslib/sparse_table.h"
 #include "ligra.h"
+#include "wBFS.h"
 #include "pbbslib/dyn_arr.h"
 #include "pbbslib/sparse_table.h"
 
@@ -287,4 +291,205 @@ inline pbbs::sequence<edge> Spanner(graph<vertex>& GA, double beta) {
   return Spanner_impl(GA, beta);
 }
 
+// Weighted spanners use the weight-class reduction: the edges with weights in
+// [2^i, 2^{i+1}) form class i, an O(k)-spanner of every class is built with the
+// unweighted construction above, and the union of the class spanners is an
+// O(k)-spanner of the weighted graph (weights within a class differ by less
+// than a factor of two) with O(n^{1+1/k} log W) edges. Weights are assumed to
+// be positive; edges of weight at most 1 go to class 0.
+template <class W>
+inline size_t weight_class(const W& w) {
+  return (w <= 1) ? 0 : pbbslib::log2_up(static_cast<size_t>(w) + 1) - 1;
+}
+
+template <template <class W> class vertex, class W>
+inline pbbs::sequence<std::tuple<uintE, uintE, W>> WeightedSpanner(
+    graph<vertex<W>>& GA, double beta) {
+  using wedge = std::tuple<uintE, uintE, W>;
+  size_t n = GA.n;
+
+  // Collect every undirected edge once and group the edges by weight class.
+  auto offsets = pbbs::sequence<size_t>(n + 1);
+  auto lt = [&](const uintE& u, const uintE& v, const W& w) { return u < v; };
+  par_for(0, n, 1, [&] (size_t i) { offsets[i] = GA.V[i].countOutNgh(i, lt); });
+  offsets[n] = 0;
+  size_t m = pbbslib::scan_add_inplace(offsets);
+  auto edges = pbbs::sequence<wedge>::no_init(m);
+  par_for(0, n, 1, [&] (size_t i) {
+    size_t k = offsets[i];
+    auto map_f = [&](const uintE& u, const uintE& v, const W& w) {
+      if (u < v) edges[k++] = std::make_tuple(u, v, w);
+    };
+    GA.V[i].mapOutNgh(i, map_f, false);
+  });
+  offsets.clear();
+  auto class_f = [&](const wedge& e) { return weight_class(std::get<2>(e)); };
+  auto classes = pbbs::delayed_seq<size_t>(m, [&] (size_t i) {
+    return class_f(edges[i]);
+  });
+  size_t num_classes = (m == 0) ? 0 : pbbslib::reduce_max(classes) + 1;
+  pbbslib::integer_sort_inplace(edges.slice(), class_f,
+                                pbbslib::log2_up(num_classes + 1));
+  auto is_start = pbbs::delayed_seq<bool>(m, [&] (size_t i) {
+    return (i == 0) || (class_f(edges[i]) != class_f(edges[i - 1]));
+  });
+  auto starts = pbbslib::pack_index<size_t>(is_start);
+  debug(cout << "num weight classes = " << starts.size() << endl;);
+
+  auto empty = std::make_tuple(std::make_pair(UINT_E_MAX, UINT_E_MAX),
+                               UINT_E_MAX);
+  auto hash_pair = [](const edge& t) {
+    size_t key = (static_cast<size_t>(t.first) << 32) + t.second;
+    return pbbslib::hash64_2(key);
+  };
+  auto ordered = [](uintE u, uintE v) {
+    return std::make_pair(std::min(u, v), std::max(u, v));
+  };
+
+  auto spanner = pbbslib::dyn_arr<wedge>(n);
+  for (size_t j = 0; j < starts.size(); j++) {
+    size_t s = starts[j];
+    size_t e = (j + 1 < starts.size()) ? starts[j + 1] : m;
+    auto class_edges = pbbs::sequence<wedge>(2 * (e - s), [&] (size_t i) {
+      auto& ce = edges[s + i / 2];
+      return (i % 2) ? ce : std::make_tuple(std::get<1>(ce), std::get<0>(ce),
+                                            std::get<2>(ce));
+    });
+    auto EA = edge_array<W>(class_edges.begin(), n, n, class_edges.size());
+    auto GC = sym_graph_from_edges<W>(EA);
+    auto class_spanner = Spanner_impl(GC, beta);
+    GC.del();
+
+    // The unweighted construction returns endpoints only; recover the
+    // weights (the lightest of any parallel edges) from the class edges.
+    // space_mult is a long, so the default of 1.1 truncates to 1; ask for 2x
+    // explicitly so that the table always has an empty slot and find()
+    // terminates on class edges that are not in the spanner.
+    size_t k = class_spanner.size();
+    auto table = make_sparse_table<edge, uintE>(k, empty, hash_pair, 2);
+    par_for(0, k, pbbslib::kSequentialForThreshold, [&] (size_t i) {
+      auto& se = class_spanner[i];
+      table.insert(std::make_tuple(ordered(se.first, se.second), (uintE)i));
+    });
+    auto weights = pbbs::sequence<W>(k, std::numeric_limits<W>::max());
+    par_for(s, e, pbbslib::kSequentialForThreshold, [&] (size_t i) {
+      auto& ce = edges[i];
+      uintE idx = table.find(ordered(std::get<0>(ce), std::get<1>(ce)),
+                             UINT_E_MAX);
+      if (idx != UINT_E_MAX) pbbslib::write_min(&weights[idx], std::get<2>(ce));
+    });
+    table.del();
+
+    auto with_weights = pbbs::sequence<wedge>(k, [&] (size_t i) {
+      return std::make_tuple(class_spanner[i].first, class_spanner[i].second,
+                             weights[i]);
+    });
+    spanner.copyIn(with_weights, k);
+  }
+  debug(cout << "Spanner size = " << spanner.size << endl;);
+  size_t spanner_size = spanner.size;
+  return pbbs::sequence<wedge>(spanner.A, spanner_size);
+}
+
+// Returns the spanner, given as a list of undirected edges, as a symmetric
+// graph on n vertices with sorted neighbor lists.
+template <class W>
+inline graph<symmetricVertex<W>> spanner_graph(
+    size_t n, pbbs::sequence<std::tuple<uintE, uintE, W>>& spanner_edges) {
+  using wedge = std::tuple<uintE, uintE, W>;
+  auto sym_edges = pbbs::sequence<wedge>(2 * spanner_edges.size(), [&] (size_t i) {
+    auto& e = spanner_edges[i / 2];
+    return (i % 2) ? std::make_tuple(std::get<1>(e), std::get<0>(e),
+                                     std::get<2>(e))
+                   : e;
+  });
+  auto lex_lt = [](const wedge& l, const wedge& r) {
+    return (std::get<0>(l) < std::get<0>(r)) ||
+           ((std::get<0>(l) == std::get<0>(r)) &&
+            (std::get<1>(l) < std::get<1>(r)));
+  };
+  pbbslib::sample_sort_inplace(sym_edges.slice(), lex_lt);
+  auto EA = edge_array<W>(sym_edges.begin(), n, n, sym_edges.size());
+  return sym_graph_from_edges<W>(EA, true);
+}
+
+// Distances from each of the (at most 64) sources, as one row of n distances
+// per source, with UINT_E_MAX for unreachable vertices. Unweighted graphs use
+// a bit-parallel BFS and weighted graphs one wBFS per source.
+template <template <class W> class vertex, class W>
+inline pbbs::sequence<uintE> source_distances(graph<vertex<W>>& G,
+                                              pbbs::sequence<uintE>& sources) {
+  size_t n = G.n;
+  size_t k = sources.size();
+  auto dists = pbbs::sequence<uintE>(k * n, UINT_E_MAX);
+  if constexpr (std::is_same<W, pbbslib::empty>::value) {
+    for (size_t j = 0; j < k; j++) dists[j * n + sources[j]] = 0;
+    auto visit_f = [&](uintE v, uint64_t bits, uintE round) {
+      while (bits) {
+        size_t j = __builtin_ctzl(bits);
+        dists[j * n + v] = round;
+        bits &= bits - 1;
+      }
+    };
+    eccentricity::bit_parallel_bfs(G, sources, visit_f);
+  } else {
+    for (size_t j = 0; j < k; j++) {
+      auto d = pbbs::sequence<uintE>(n, (uintE)INT_E_MAX);
+      d[sources[j]] = 0;
+      wbfs::bucketed_sssp(G, d, 128, dense_forward | no_dense | sparse_blocked,
+                          [](pbbs::sequence<uintE>& bkt) {});
+      par_for(0, n, pbbslib::kSequentialForThreshold, [&] (size_t v) {
+        if (d[v] != (uintE)INT_E_MAX) dists[j * n + v] = d[v];
+      });
+    }
+  }
+  return dists;
+}
+
+struct stretch_stats {
+  size_t pairs = 0;         // sampled pairs connected in the graph
+  size_t disconnected = 0;  // of which not connected in the spanner
+  double max_stretch = 0.0;
+  double avg_stretch = 0.0;
+};
+
+// Estimates the stretch of spanner H of G from num_samples random sources:
+// over the pairs (s, v) with 0 < d_G(s, v) < inf, the maximum and average of
+// d_H(s, v) / d_G(s, v).
+template <template <class W> class vertex, class W>
+inline stretch_stats Stretch(graph<vertex<W>>& G,
+                             graph<symmetricVertex<W>>& H,
+                             size_t num_samples) {
+  size_t n = G.n;
+  stretch_stats S;
+  double stretch_sum = 0.0;
+  auto r = pbbslib::random();
+  for (size_t done = 0; done < num_samples; done += eccentricity::kLanes) {
+    size_t b = std::min(eccentricity::kLanes, num_samples - done);
+    auto batch = pbbs::sequence<uintE>(b, [&] (size_t j) {
+      return r.ith_rand(done + j) % n;
+    });
+    auto dg = source_distances(G, batch);
+    auto dh = source_distances(H, batch);
+    auto connected = pbbs::delayed_seq<size_t>(b * n, [&] (size_t i) {
+      return static_cast<size_t>(dg[i] != UINT_E_MAX && dg[i] > 0);
+    });
+    auto lost = pbbs::delayed_seq<size_t>(b * n, [&] (size_t i) {
+      return static_cast<size_t>(connected[i] && dh[i] == UINT_E_MAX);
+    });
+    auto stretch = pbbs::delayed_seq<double>(b * n, [&] (size_t i) -> double {
+      return (connected[i] && dh[i] != UINT_E_MAX)
+                 ? static_cast<double>(dh[i]) / dg[i]
+                 : 0.0;
+    });
+    S.pairs += pbbslib::reduce_add(connected);
+    S.disconnected += pbbslib::reduce_add(lost);
+    S.max_stretch = std::max(S.max_stretch, pbbslib::reduce_max(stretch));
+    stretch_sum += pbbslib::reduce_add(stretch);
+  }
+  size_t measured = S.pairs - S.disconnected;
+  S.avg_stretch = (measured > 0) ? stretch_sum / measured : 0.0;
+  return S;
+}
+
 }  // namespace cc
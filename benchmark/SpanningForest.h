@@ -29,6 +29,7 @@
 #include "pbbslib/dyn_arr.h"
 #include "ligra.h"
 #include "contract_sf.h"
+#include "union_find.h"
 
 namespace spanning_forest {
 
@@ -244,7 +245,8 @@ namespace spanning_forest {
   template <template <class W> class vertex, class W>
   inline pbbslib::dyn_arr<edge> SpanningForest_Impl(graph<vertex<W>>& GA, double beta,
                                             size_t level, std::function<edge(edge)>& edge_mapping, bool
-                                            pack = false, bool permute = false)
+                                            pack = false, bool permute = false,
+                                            bool semisort = false)
   {
     permute |= (level > 0);
     timer ldd_t;
@@ -277,7 +279,7 @@ namespace spanning_forest {
     // The contraction here also returns a mapping from edge --> edge. This is
     // because edges incident to a single contracted vertex can come from
     // multiple original vertices.
-    auto GC_and_new_mapping = contract_sf::contract(GA, clusters, num_clusters, edge_mapping);
+    auto GC_and_new_mapping = contract_sf::contract(GA, clusters, num_clusters, edge_mapping, semisort);
     contract_t.stop();
     debug(contract_t.reportTotal("contract time"););
     auto GC = GC_and_new_mapping.first;
@@ -295,7 +297,7 @@ namespace spanning_forest {
       return ret;
     };
 
-    auto rec_edge_arr = SpanningForest_Impl(GC, beta, level + 1, new_edge_mapping);
+    auto rec_edge_arr = SpanningForest_Impl(GC, beta, level + 1, new_edge_mapping, false, false, semisort);
     rec_edge_arr.copyIn(edges, edges.size());
     GC.del();
     return rec_edge_arr;
@@ -305,11 +307,85 @@ namespace spanning_forest {
   // edges (initially just identity).
   template <class vertex>
   inline pbbslib::dyn_arr<edge> SpanningForest(graph<vertex>& GA, double beta = 0.2,
-                                        bool pack = false, bool permute = false) {
+                                        bool pack = false, bool permute = false,
+                                        bool semisort = false) {
     std::function<edge(edge)> identity_mapping = [&] (edge e) {
       return e;
     };
-    return SpanningForest_Impl(GA, beta, 0, identity_mapping, pack, permute);
+    return SpanningForest_Impl(GA, beta, 0, identity_mapping, pack, permute, semisort);
+  }
+
+  // Union-find spanning forest. Every vertex is first linked along its first
+  // neighbor_rounds edges, which is usually enough to place most of a giant
+  // component in one tree. The most frequent root among num_samples sampled
+  // vertices identifies that tree, and the finish phase then links along all
+  // edges of the vertices outside it: an edge from the giant tree to another
+  // tree is also an edge of a vertex in the other tree, so it is not missed.
+  // A successful link records its edge at the root that was linked, and since
+  // every root is linked at most once the recorded edges form a spanning
+  // forest.
+  template <template <class W> class vertex, class W>
+  inline pbbslib::dyn_arr<edge> UnionFindSpanningForest(graph<vertex<W>>& GA,
+      size_t neighbor_rounds = 2, size_t num_samples = 1024) {
+    size_t n = GA.n;
+    auto parents = sequence<uintE>(n, [&] (size_t i) { return i; });
+    auto link_edges = sequence<edge>(n, std::make_pair(UINT_E_MAX, UINT_E_MAX));
+    auto link_f = [&] (uintE u, uintE v) {
+      uintE root;
+      if (union_find::unite_root<uintE>(u, v, parents.begin(), &root)) {
+        link_edges[root] = std::make_pair(u, v);
+      }
+    };
+
+    timer sample_t;
+    sample_t.start();
+    for (size_t r = 0; r < neighbor_rounds; r++) {
+      par_for(0, n, pbbslib::kSequentialForThreshold, [&] (size_t i) {
+        if (GA.V[i].getOutDegree() > r) {
+          link_f(i, std::get<0>(GA.V[i].get_ith_out_neighbor(i, r)));
+        }
+      });
+    }
+
+    uintE frequent = UINT_E_MAX;
+    if (n > 0) {
+      auto rnd = pbbslib::random();
+      auto sample = sequence<uintE>(num_samples, [&] (size_t i) {
+        return union_find::find_compress<uintE>(rnd.ith_rand(i) % n,
+                                                parents.begin());
+      });
+      pbbslib::sample_sort_inplace(sample.slice(), std::less<uintE>());
+      size_t best = 0;
+      for (size_t i = 0, j = 0; i < num_samples; i = j) {
+        while (j < num_samples && sample[j] == sample[i]) j++;
+        if (j - i > best) {
+          best = j - i;
+          frequent = sample[i];
+        }
+      }
+      debug(cout << "frequent root = " << frequent << " (" << best << "/"
+                 << num_samples << " samples)" << endl;);
+    }
+    sample_t.stop();
+    debug(sample_t.reportTotal("sample time"););
+
+    timer finish_t;
+    finish_t.start();
+    par_for(0, n, 1, [&] (size_t i) {
+      if (union_find::find_compress<uintE>(i, parents.begin()) != frequent) {
+        auto map_f = [&] (const uintE& src, const uintE& ngh, const W& w) {
+          link_f(src, ngh);
+        };
+        GA.V[i].mapOutNgh(i, map_f);
+      }
+    });
+    finish_t.stop();
+    debug(finish_t.reportTotal("finish time"););
+
+    auto pred = [&] (const edge& e) { return e.first != UINT_E_MAX; };
+    auto edges = pbbslib::filter(link_edges, pred);
+    size_t num_edges = edges.size();
+    return pbbslib::dyn_arr<edge>(edges.to_array(), num_edges, num_edges, true);
   }
 
 }  // namespace spanning_forest
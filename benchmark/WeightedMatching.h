@@ -0,0 +1,264 @@
+// This code is part of the project "Theoretically Efficient Parallel Graph
+// Algorithms Can Be Fast and Scalable", presented at Symposium on Parallelism
+// in Algorithms and Architectures, 2018.
+// Copyright (c) 2018 Laxman Dhulipala, Guy Blelloch, and Julian Shun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all  copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cmath>
+
+#include "MaximalMatching.h"
+
+namespace weighted_matching {
+
+  constexpr uintE NONE = UINT_E_MAX;
+
+  // Orders edges by weight, breaking ties by a random hash of the endpoints.
+  template <class W>
+  inline size_t weight_priority(uintE u, uintE v, W wgh, pbbslib::random r) {
+    size_t biased = ((uint32_t)wgh) ^ ((uint32_t)1 << 31);
+    return (biased << 32) | (mm::key_for_pair(u, v, r) & 0xFFFFFFFF);
+  }
+
+  // An augmentation centered at v of length at most two: v is matched to u
+  // and, if v was matched to x, x is matched to y (y == NONE means x is left
+  // unmatched). touched holds every vertex whose mate changes.
+  template <class W>
+  struct augmentation {
+    uintE v, u, x, y;
+    W w_vu, w_xy;
+    uintE touched[6];
+  };
+
+  // Arm of center c: rematch c to ngh, gaining wgh - mate_wgh[ngh].
+  template <class W>
+  struct arm {
+    uintE ngh;
+    long gain;
+    W wgh;
+  };
+
+  // Finds the two best arms of c that avoid excl.
+  template <class Graph, class W>
+  inline void best_arms(Graph& G, uintE c, uintE excl, uintE* mate,
+                        W* mate_wgh, arm<W>& a1, arm<W>& a2) {
+    a1 = {NONE, 0, W()};
+    a2 = {NONE, 0, W()};
+    auto map_f = [&](const uintE& src, const uintE& ngh, const W& wgh) {
+      if (ngh == src || ngh == excl) return;
+      long gain = (long)wgh - (mate[ngh] == NONE ? 0 : (long)mate_wgh[ngh]);
+      if (a1.ngh == NONE || gain > a1.gain) {
+        a2 = a1;
+        a1 = {ngh, gain, wgh};
+      } else if (a2.ngh == NONE || gain > a2.gain) {
+        a2 = {ngh, gain, wgh};
+      }
+    };
+    G.V[c].mapOutNgh(c, map_f, false);
+  }
+
+  // Step for speculative_for: iteration i tries to apply the best augmentation
+  // centered at order[i]. Winners touch disjoint vertex sets, so the
+  // augmentation computed in reserve is still valid at commit.
+  template <class Graph, class W>
+  struct augmentStep {
+    Graph& G;
+    uintE* order;
+    uintE* mate;
+    W* mate_wgh;
+    reservation<uintE>* R;
+    augmentation<W>* aug;
+    bool* applied;
+
+    augmentStep(Graph& _G, uintE* _order, uintE* _mate, W* _mate_wgh,
+                reservation<uintE>* _R, augmentation<W>* _aug, bool* _applied)
+        : G(_G), order(_order), mate(_mate), mate_wgh(_mate_wgh), R(_R),
+          aug(_aug), applied(_applied) {}
+
+    inline long mw(uintE v) { return mate[v] == NONE ? 0 : (long)mate_wgh[v]; }
+
+    bool reserve(uintE i) {
+      uintE v = order[i];
+      uintE x = mate[v];
+      arm<W> v1, v2;
+      best_arms(G, v, x, mate, mate_wgh, v1, v2);
+      if (v1.ngh == NONE) return 0;
+
+      // Rematch only v.
+      long best_gain = v1.gain - mw(v);
+      arm<W> bu = v1, by = {NONE, 0, W()};
+      // Rematch both v and its mate x.
+      if (x != NONE) {
+        arm<W> x1, x2;
+        best_arms(G, x, v, mate, mate_wgh, x1, x2);
+        arm<W> va[2] = {v1, v2};
+        arm<W> xa[2] = {x1, x2};
+        for (size_t j = 0; j < 2; j++) {
+          for (size_t k = 0; k < 2; k++) {
+            uintE u = va[j].ngh, y = xa[k].ngh;
+            if (u == NONE || y == NONE || u == y) continue;
+            // If u and y were matched to each other, their edge was
+            // subtracted twice.
+            long gain = va[j].gain + xa[k].gain - mw(v) +
+                        ((mate[u] == y) ? mw(u) : 0);
+            if (gain > best_gain) {
+              best_gain = gain;
+              bu = va[j];
+              by = xa[k];
+            }
+          }
+        }
+      }
+      if (best_gain <= 0) return 0;
+
+      auto& a = aug[i];
+      a.v = v;
+      a.u = bu.ngh;
+      a.x = x;
+      a.y = by.ngh;
+      a.w_vu = bu.wgh;
+      a.w_xy = by.wgh;
+      a.touched[0] = v;
+      a.touched[1] = a.u;
+      a.touched[2] = mate[a.u];
+      a.touched[3] = x;
+      a.touched[4] = a.y;
+      a.touched[5] = (a.y == NONE) ? NONE : mate[a.y];
+      for (size_t j = 0; j < 6; j++) {
+        if (a.touched[j] != NONE) R[a.touched[j]].reserve(i);
+      }
+      return 1;
+    }
+
+    bool commit(uintE i) {
+      auto& a = aug[i];
+      bool won = true;
+      for (size_t j = 0; j < 6; j++) {
+        if (a.touched[j] != NONE && !R[a.touched[j]].check(i)) won = false;
+      }
+      if (won) {
+        for (size_t j = 0; j < 6; j++) {
+          uintE t = a.touched[j];
+          if (t != NONE) mate[t] = NONE;
+        }
+        mate[a.v] = a.u; mate[a.u] = a.v;
+        mate_wgh[a.v] = mate_wgh[a.u] = a.w_vu;
+        if (a.y != NONE) {
+          mate[a.x] = a.y; mate[a.y] = a.x;
+          mate_wgh[a.x] = mate_wgh[a.y] = a.w_xy;
+        }
+        applied[i] = true;
+      }
+      for (size_t j = 0; j < 6; j++) {
+        if (a.touched[j] != NONE) R[a.touched[j]].checkReset(i);
+      }
+      return won;
+    }
+  };
+
+  template <class W>
+  inline long matching_weight(sequence<std::tuple<uintE, uintE, W>>& M) {
+    auto wgh_im = pbbslib::make_sequence<long>(
+        M.size(), [&](size_t i) { return (long)std::get<2>(M[i]); });
+    return pbbslib::reduce_add(wgh_im);
+  }
+
+}  // namespace weighted_matching
+
+// Approximate maximum-weight matching. A locally-dominant matching with edges
+// ordered by weight is a 1/2-approximation. Unless half_approx is set, it is
+// then improved with rounds of short augmentations in the style of Pettie and
+// Sanders: each round visits the vertices in a random order and applies the
+// best augmentation of length at most two centered at each one, which gives a
+// (2/3 - eps)-approximation in expectation after O(log(1/eps)) rounds.
+// Augmentations can unmatch vertices, so the result is finally extended to a
+// maximal matching. The graph is not mutated.
+template <template <class W> class vertex, class W>
+inline sequence<std::tuple<uintE, uintE, W>> WeightedMatching(
+    graph<vertex<W>>& G, double eps = 0.1, bool half_approx = false,
+    spec_for_state<uintE>* st = nullptr) {
+  using namespace weighted_matching;
+  using edge = std::tuple<uintE, uintE, W>;
+  timer mt;
+  mt.start();
+  size_t n = G.n;
+  auto r = pbbslib::random();
+  auto prio = [&](const uintE& u, const uintE& v, const W& wgh) {
+    return weight_priority(u, v, wgh, r);
+  };
+
+  auto matched = sequence<bool>(n, [&](size_t i) { return false; });
+  auto M = mm::locally_dominant(G, matched.begin(), prio);
+  std::cout << "locally-dominant matching weight = " << matching_weight(M)
+            << "\n";
+  if (half_approx) {
+    mt.stop();
+    mt.reportTotal("Matching time");
+    return M;
+  }
+
+  auto mate = sequence<uintE>(n, [&](size_t i) { return NONE; });
+  auto mate_wgh = sequence<W>(n);
+  par_for(0, M.size(), pbbslib::kSequentialForThreshold, [&] (size_t i) {
+    uintE u = std::get<0>(M[i]), v = std::get<1>(M[i]);
+    mate[u] = v; mate[v] = u;
+    mate_wgh[u] = mate_wgh[v] = std::get<2>(M[i]);
+  });
+
+  auto R = sequence<reservation<uintE>>(n);
+  auto aug = sequence<augmentation<W>>(n);
+  auto applied = sequence<bool>(n);
+  spec_for_state<uintE> local;
+  if (st == nullptr) st = &local;
+  size_t rounds = std::max((size_t)1, (size_t)std::ceil(1.5 * std::log(1.0 / eps)));
+  for (size_t round = 0; round < rounds; round++) {
+    auto order = pbbslib::random_permutation<uintE>(n, r.fork(round));
+    par_for(0, n, pbbslib::kSequentialForThreshold, [&] (size_t i)
+                    { applied[i] = false; });
+    auto step = augmentStep<graph<vertex<W>>, W>(
+        G, order.begin(), mate.begin(), mate_wgh.begin(), R.begin(),
+        aug.begin(), applied.begin());
+    speculative_for<uintE>(step, 0, n, 8, 1, -1, st);
+    auto applied_im = pbbslib::make_sequence<size_t>(
+        n, [&](size_t i) { return (size_t)applied[i]; });
+    size_t n_applied = pbbslib::reduce_add(applied_im);
+    std::cout << "round = " << round << " applied " << n_applied
+              << " augmentations\n";
+    if (n_applied == 0) break;
+  }
+
+  // Extend to a maximal matching.
+  par_for(0, n, pbbslib::kSequentialForThreshold, [&] (size_t i)
+                  { matched[i] = (mate[i] != NONE); });
+  auto extra = mm::locally_dominant(G, matched.begin(), prio);
+
+  auto v_im = pbbslib::make_sequence<uintE>(n, [](size_t i) { return i; });
+  auto leaders = pbbslib::filter(
+      v_im, [&](uintE v) { return mate[v] != NONE && v < mate[v]; });
+  auto ret = sequence<edge>(leaders.size() + extra.size(), [&](size_t i) {
+    if (i >= leaders.size()) return extra[i - leaders.size()];
+    uintE v = leaders[i];
+    return std::make_tuple(v, mate[v], mate_wgh[v]);
+  });
+  mt.stop();
+  mt.reportTotal("Matching time");
+  return ret;
+}
@@ -26,6 +26,10 @@
 #include <cmath>
 #include "bucket.h"
 #include "ligra.h"
+#include "speculative_for.h"
+#include "union_find.h"
+
+#include "pbbslib/sample_sort.h"
 
 namespace widestpath {
 constexpr uintE TOP_BIT = ((uintE)INT_E_MAX) + 1;
@@ -99,7 +103,8 @@ inline sequence<uintE> WidestPath(graph<vertex<W>>& G, uintE src,
   width[src] = INT_E_MAX;
 
   auto get_bkt = [&](const uintE& width) -> const uintE {
-    return max_weight - width + 1;
+    // Unreached vertices (width 0) are not in any bucket.
+    return (width == 0) ? UINT_E_MAX : max_weight - width + 1;
   };
   auto get_ring = pbbslib::make_sequence<uintE>(n, [&](const size_t& v) -> const uintE {
     auto d = width[v];
@@ -174,6 +179,232 @@ inline sequence<uintE> WidestPath(graph<vertex<W>>& G, uintE src,
   return width;
 }
 
+// Widest-path index. Every bottleneck path of a graph can be taken inside its
+// maximum spanning forest, so the width of (s, t) is the lightest edge on the
+// forest path between them. The index stores the forest rooted in each tree
+// together with binary-lifting tables of ancestors and path minima, answering
+// a pair query in O(log n) and all widths from a source in O(n).
+namespace widestpath {
+using wedge = std::tuple<uintE, uintE, intE>;
+
+// Computes a maximum spanning forest by running the speculative union-find
+// step of MST_spec_for over the edges sorted by negated weight. roots is set
+// to one vertex from each tree.
+template <template <class W> class vertex, class W>
+inline sequence<wedge> max_spanning_forest(graph<vertex<W>>& G,
+                                           sequence<uintE>& roots) {
+  using res = reservation<uintE>;
+  size_t n = G.n;
+  auto pred = [&](const uintE& u, const uintE& v, const W& wgh) -> bool {
+    return u < v;
+  };
+  auto E = sample_edges(G, pred);
+  size_t n_edges = E.non_zeros;
+  par_for(0, n_edges, pbbslib::kSequentialForThreshold, [&] (size_t i)
+                  { std::get<2>(E.E[i]) = -std::get<2>(E.E[i]); });
+  auto cmp_by_wgh = [](const wedge& l, const wedge& r) {
+    return std::get<2>(l) < std::get<2>(r);
+  };
+  pbbslib::sample_sort_inplace(pbbs::make_range(E.E, E.E + n_edges),
+                               cmp_by_wgh);
+
+  auto uf = UnionFind(n);
+  auto R = pbbslib::new_array_no_init<res>(n);
+  par_for(0, n, pbbslib::kSequentialForThreshold, [&] (size_t i)
+                  { R[i] = res(); });
+  auto msf_flags = sequence<bool>(n_edges, false);
+  auto UFStep = make_uf_step<uintE>(E, R, msf_flags, uf);
+  speculative_for<uintE>(UFStep, 0, n_edges, 8, 1);
+  UFStep.clear();
+  pbbslib::free_array(R);
+  auto is_root = pbbslib::make_sequence<bool>(n, [&](size_t i) {
+    return uf.parents[i] < 0;
+  });
+  roots = pbbslib::pack_index<uintE>(is_root);
+  uf.clear();
+
+  auto edge_im = pbbslib::make_sequence<wedge>(n_edges, [&](size_t i) {
+    auto e = E.E[i];
+    return std::make_tuple(std::get<0>(e), std::get<1>(e), -std::get<2>(e));
+  });
+  auto forest = pbbslib::pack(edge_im, msf_flags);
+  E.del();
+  return forest;
+}
+
+struct bottleneck_index {
+  size_t n;
+  size_t levels;
+  // The forest in CSR form: the neighbors of v are nghs[offsets[v]..offsets[v+1]).
+  sequence<size_t> offsets;
+  sequence<std::tuple<uintE, intE>> nghs;
+  sequence<uintE> root;
+  sequence<uintE> depth;
+  // up[j*n + v] is the 2^j'th ancestor of v (roots are their own parent) and
+  // up_width[j*n + v] is the lightest edge on the path to it.
+  sequence<uintE> up;
+  sequence<uintE> up_width;
+
+  bottleneck_index() : n(0), levels(0) {}
+
+  // Visits the trees containing frontier level by level, calling
+  // f(parent, child, weight) in parallel for every tree edge. All edges into a
+  // level are visited before any edge out of it. parent must map the vertices
+  // in frontier to themselves and every other vertex to UINT_E_MAX.
+  template <class F>
+  void traverse(sequence<uintE> frontier, sequence<uintE>& parent, F f) const {
+    while (frontier.size() > 0) {
+      size_t k = frontier.size();
+      auto offs = sequence<size_t>(k + 1, [&](size_t i) -> size_t {
+        if (i == k) return 0;
+        uintE v = frontier[i];
+        size_t deg = offsets[v + 1] - offsets[v];
+        return (parent[v] == v) ? deg : deg - 1;
+      });
+      size_t total = pbbslib::scan_add_inplace(offs);
+      auto next = sequence<uintE>::no_init(total);
+      par_for(0, k, 1, [&] (size_t i) {
+        uintE v = frontier[i];
+        size_t j = offs[i];
+        for (size_t e = offsets[v]; e < offsets[v + 1]; e++) {
+          uintE u = std::get<0>(nghs[e]);
+          if (u == parent[v]) continue;
+          parent[u] = v;
+          f(v, u, std::get<1>(nghs[e]));
+          next[j++] = u;
+        }
+      });
+      frontier = std::move(next);
+    }
+  }
+
+  // Width of the widest s-t path: INT_E_MAX if s == t and 0 if t is not
+  // reachable from s.
+  uintE query(uintE s, uintE t) const {
+    if (s == t) return INT_E_MAX;
+    if (root[s] != root[t]) return 0;
+    uintE width = INT_E_MAX;
+    if (depth[s] < depth[t]) std::swap(s, t);
+    uintE diff = depth[s] - depth[t];
+    for (size_t j = 0; diff > 0; j++, diff >>= 1) {
+      if (diff & 1) {
+        width = std::min(width, up_width[j * n + s]);
+        s = up[j * n + s];
+      }
+    }
+    if (s == t) return width;
+    for (size_t j = levels; j-- > 0;) {
+      if (up[j * n + s] != up[j * n + t]) {
+        width = std::min(width, std::min(up_width[j * n + s], up_width[j * n + t]));
+        s = up[j * n + s];
+        t = up[j * n + t];
+      }
+    }
+    return std::min(width, std::min(up_width[s], up_width[t]));
+  }
+
+  // Widths of the widest paths from src to every vertex, with the same
+  // conventions as query.
+  sequence<uintE> widths_from(uintE src) const {
+    auto width = sequence<uintE>(n, (uintE)0);
+    auto parent = sequence<uintE>(n, UINT_E_MAX);
+    width[src] = INT_E_MAX;
+    parent[src] = src;
+    traverse(sequence<uintE>(1, src), parent,
+             [&](uintE p, uintE c, intE w) {
+               width[c] = std::min(width[p], (uintE)w);
+             });
+    return width;
+  }
+};
+
+}  // namespace widestpath
+
+template <
+    template <typename W> class vertex, class W,
+    typename std::enable_if<std::is_same<W, int32_t>::value, int>::type = 0>
+inline widestpath::bottleneck_index WidestPathIndex(graph<vertex<W>>& G) {
+  size_t n = G.n;
+  widestpath::bottleneck_index I;
+  I.n = n;
+
+  timer ft; ft.start();
+  sequence<uintE> roots;
+  auto forest = widestpath::max_spanning_forest(G, roots);
+  ft.stop(); ft.reportTotal("max spanning forest time");
+  std::cout << "forest edges = " << forest.size() << "\n";
+
+  // Build the forest in CSR form.
+  size_t k = forest.size();
+  auto arcs = sequence<widestpath::wedge>(2 * k, [&](size_t i) {
+    auto e = forest[i / 2];
+    return (i & 1) ? std::make_tuple(std::get<1>(e), std::get<0>(e), std::get<2>(e))
+                   : e;
+  });
+  auto first = [&](const widestpath::wedge& e) { return std::get<0>(e); };
+  pbbslib::integer_sort_inplace(arcs.slice(), first, pbbslib::log2_up(n));
+  I.offsets = sequence<size_t>(n + 1, (size_t)0);
+  par_for(0, 2 * k, pbbslib::kSequentialForThreshold, [&] (size_t i) {
+    uintE v = std::get<0>(arcs[i]);
+    if (i + 1 == 2 * k || std::get<0>(arcs[i + 1]) != v) {
+      I.offsets[v] = i + 1;
+    }
+  });
+  // offsets[v] currently holds the end of v's run (or 0); turn it into a
+  // count and scan.
+  par_for(0, 2 * k, pbbslib::kSequentialForThreshold, [&] (size_t i) {
+    uintE v = std::get<0>(arcs[i]);
+    if (i == 0 || std::get<0>(arcs[i - 1]) != v) {
+      I.offsets[v] -= i;
+    }
+  });
+  pbbslib::scan_add_inplace(I.offsets);
+  I.nghs = sequence<std::tuple<uintE, intE>>(2 * k, [&](size_t i) {
+    return std::make_tuple(std::get<1>(arcs[i]), std::get<2>(arcs[i]));
+  });
+
+  // Root each tree at its union-find representative, then fill in the first
+  // level of the lifting tables while traversing the trees.
+  I.levels = std::max((size_t)1, (size_t)pbbslib::log2_up(n));
+  I.root = sequence<uintE>::no_init(n);
+  I.depth = sequence<uintE>::no_init(n);
+  I.up = sequence<uintE>::no_init(I.levels * n);
+  I.up_width = sequence<uintE>::no_init(I.levels * n);
+  auto parent = sequence<uintE>(n, UINT_E_MAX);
+  par_for(0, roots.size(), pbbslib::kSequentialForThreshold, [&] (size_t i) {
+    uintE r = roots[i];
+    parent[r] = r;
+    I.root[r] = r;
+    I.depth[r] = 0;
+    I.up[r] = r;
+    I.up_width[r] = INT_E_MAX;
+  });
+  I.traverse(std::move(roots), parent, [&](uintE p, uintE c, intE w) {
+    I.root[c] = I.root[p];
+    I.depth[c] = I.depth[p] + 1;
+    I.up[c] = p;
+    I.up_width[c] = w;
+  });
+  for (size_t j = 1; j < I.levels; j++) {
+    uintE* prev = I.up.begin() + (j - 1) * n;
+    uintE* prev_width = I.up_width.begin() + (j - 1) * n;
+    par_for(0, n, pbbslib::kSequentialForThreshold, [&] (size_t v) {
+      uintE mid = prev[v];
+      I.up[j * n + v] = prev[mid];
+      I.up_width[j * n + v] = std::min(prev_width[v], prev_width[mid]);
+    });
+  }
+  return I;
+}
+
+template <
+    template <typename W> class vertex, class W,
+    typename std::enable_if<!std::is_same<W, int32_t>::value, int>::type = 0>
+inline widestpath::bottleneck_index WidestPathIndex(graph<vertex<W>>& G) {
+  assert(false);  // Unimplemented for unweighted graphs; use connectivity.
+  return widestpath::bottleneck_index();
+}
+
 struct WidestPathBF_F {
   intE* width;
   intE* Visited;
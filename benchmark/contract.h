@@ -1,6 +1,7 @@
 #pragma once
 
 #include "pbbslib/sparse_table.h"
+#include "contract_sort.h"
 #include <tuple>
 
 namespace contract {
@@ -175,21 +176,35 @@ namespace contract {
     return std::make_pair(edge_ret, edge_size);
   }
 
+  // Fetch edges by grouping them by source cluster (see contract_sort.h)
+  template <template <typename W> class vertex, class W, class C>
+  std::pair<edge*, size_t> fetch_intercluster_sort(graph<vertex<W>>& GA, C& clusters, size_t num_clusters) {
+    auto value_f = [&](const uintE& src, const uintE& ngh) { return pbbslib::empty(); };
+    auto edges = contract_sort::fetch_intercluster<pbbslib::empty>(GA, clusters, num_clusters, value_f);
+    size_t edge_size = edges.size();
+    auto edge_ret = pbbslib::new_array_no_init<edge>(edge_size);
+    par_for(0, edge_size, pbbslib::kSequentialForThreshold, [&] (size_t i) {
+      edge_ret[i] = std::make_tuple(std::get<0>(edges[i]), std::get<1>(edges[i]));
+    });
+    return std::make_pair(edge_ret, edge_size);
+  }
+
+  // Removes duplicate inter-cluster edges by hashing, or by sorting if
+  // semisort is set.
   template <template <typename W> class vertex, class W>
   inline std::tuple<graph<symmetricVertex<pbbslib::empty>>, sequence<uintE>, sequence<uintE>>
-  contract(graph<vertex<W>>& GA, sequence<uintE>& clusters, size_t num_clusters) {
-    // Remove duplicates by hashing
+  contract(graph<vertex<W>>& GA, sequence<uintE>& clusters, size_t num_clusters, bool semisort = false) {
     using K = std::tuple<uintE, uintE>;
-    using V = pbbslib::empty;
-    using KV = std::tuple<K, V>;
-
-    size_t n = GA.n;
 
     edge* edges;
     size_t edges_size;
-    std::tie(edges, edges_size) = (num_clusters < small_cluster_size) ?
-      fetch_intercluster_small(GA, clusters, num_clusters) :
-      fetch_intercluster(GA, clusters, num_clusters);
+    if (semisort) {
+      std::tie(edges, edges_size) = fetch_intercluster_sort(GA, clusters, num_clusters);
+    } else {
+      std::tie(edges, edges_size) = (num_clusters < small_cluster_size) ?
+        fetch_intercluster_small(GA, clusters, num_clusters) :
+        fetch_intercluster(GA, clusters, num_clusters);
+    }
 
     // Pack out singleton clusters
     auto flags = sequence<uintE>(num_clusters + 1, static_cast<uintE>(0));
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "pbbslib/sparse_table.h"
+#include "contract_sort.h"
 #include <tuple>
 
 namespace contract_sf {
@@ -155,18 +156,29 @@ namespace contract_sf {
   }
 
   template <template <typename W> class vertex, class W, class E>
-  inline auto contract(graph<vertex<W>>& GA, sequence<uintE>& clusters, size_t num_clusters, E& edge_mapping) {
-    // Remove duplicates by hashing
-    size_t n = GA.n;
+  inline auto contract(graph<vertex<W>>& GA, sequence<uintE>& clusters, size_t num_clusters, E& edge_mapping, bool semisort = false) {
+    // Remove duplicates by hashing, or by sorting if semisort is set
     using K = std::pair<uintE, uintE>;
     using V = std::pair<uintE, uintE>;
     using KV = std::tuple<K, V>;
 
-    auto table = (num_clusters < small_cluster_size) ?
-      fetch_intercluster_small(GA, clusters, num_clusters, edge_mapping) :
-      fetch_intercluster(GA, clusters, num_clusters, edge_mapping);
-
-    auto edges = table.entries(); // sequence
+    sequence<KV> edges;
+    if (semisort) {
+      auto value_f = [&](const uintE& src, const uintE& ngh) -> V {
+        return edge_mapping(std::make_pair(src, ngh));
+      };
+      auto sorted = contract_sort::fetch_intercluster<V>(GA, clusters, num_clusters, value_f);
+      edges = sequence<KV>(sorted.size(), [&] (size_t i) {
+        return std::make_tuple(std::make_pair(std::get<0>(sorted[i]), std::get<1>(sorted[i])),
+                               std::get<2>(sorted[i]));
+      });
+    } else {
+      auto table = (num_clusters < small_cluster_size) ?
+        fetch_intercluster_small(GA, clusters, num_clusters, edge_mapping) :
+        fetch_intercluster(GA, clusters, num_clusters, edge_mapping);
+      edges = table.entries(); // sequence
+      table.del();
+    }
     size_t edges_size = edges.size();
 
     // Pack out singleton clusters
@@ -206,24 +218,21 @@ namespace contract_sf {
 
     auto GC = sym_graph_from_edges<pbbslib::empty>(EA);
 
-    debug(cout << "table.size = " << table.m << endl;);
-    auto ret_table = sparse_table<K, V, hash_pair>(table.m, table.empty, hash_pair());
-    // Go through the edge table and map edges to their new ids
-    parallel_for(0, table.m, [&] (size_t i) {
-      auto& e = table.table[i];
-      if (e != table.empty) {
-        auto& e0 = std::get<0>(e);
-        auto& e1 = std::get<1>(e);
-        uintE u = flags[e0.first];
-        uintE v = flags[e0.second];
-        uintE fst = std::min(u,v);
-        uintE snd = std::max(u,v);
-        ret_table.insert(std::make_tuple(std::make_pair(fst, snd), e1));
-      }
+    KV empty =
+        std::make_tuple(std::make_pair(UINT_E_MAX, UINT_E_MAX), std::make_pair(UINT_E_MAX, UINT_E_MAX));
+    auto ret_table = sparse_table<K, V, hash_pair>(edges_size, empty, hash_pair(), 2);
+    debug(cout << "table.size = " << ret_table.m << endl;);
+    // Go through the edges and map them to their new ids
+    parallel_for(0, edges_size, [&] (size_t i) {
+      auto& e0 = std::get<0>(edges[i]);
+      auto& e1 = std::get<1>(edges[i]);
+      uintE u = flags[e0.first];
+      uintE v = flags[e0.second];
+      uintE fst = std::min(u,v);
+      uintE snd = std::max(u,v);
+      ret_table.insert(std::make_tuple(std::make_pair(fst, snd), e1));
     });
 
-    table.clear();
-
     return std::make_pair(GC, ret_table);
   }
 
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <algorithm>
+#include <tuple>
+
+#include "ligra.h"
+
+// Sort-based deduplication of inter-cluster edges, shared by contract and
+// contract_sf. Instead of inserting every edge into one global hash table,
+// the edges are written to an array, grouped by source cluster with an
+// integer sort, and deduplicated within each group.
+namespace contract_sort {
+
+  // Groups larger than this are sorted in parallel.
+  constexpr size_t kSeqSortThreshold = 2048;
+
+  // Returns the edges (c_src, c_ngh, value_f(src, ngh)) for the edges (src,
+  // ngh) of GA with c_src = clusters[src] < c_ngh = clusters[ngh], keeping
+  // one (arbitrary) edge per cluster pair.
+  template <class V, template <typename W> class vertex, class W, class C,
+            class F>
+  sequence<std::tuple<uintE, uintE, V>> fetch_intercluster(
+      graph<vertex<W>>& GA, C& clusters, size_t num_clusters, F& value_f) {
+    debug(cout << "Running fetch edges sort" << endl;);
+    using T = std::tuple<uintE, uintE, V>;
+    size_t n = GA.n;
+
+    timer count_t;
+    count_t.start();
+    auto deg_map = sequence<size_t>(n + 1);
+    auto pred = [&](const uintE& src, const uintE& ngh, const W& w) {
+      return clusters[src] < clusters[ngh];
+    };
+    par_for(0, n, 1, [&] (size_t i)
+                    { deg_map[i] = GA.V[i].countOutNgh(i, pred); });
+    deg_map[n] = 0;
+    size_t m = pbbslib::scan_add_inplace(deg_map);
+    count_t.stop();
+    debug(count_t.reportTotal("count time"););
+
+    timer sort_t;
+    sort_t.start();
+    auto edges = sequence<T>::no_init(m);
+    par_for(0, n, 1, [&] (size_t i) {
+      size_t k = deg_map[i];
+      auto map_f = [&](const uintE& src, const uintE& ngh, const W& w) {
+        uintE c_src = clusters[src];
+        uintE c_ngh = clusters[ngh];
+        if (c_src < c_ngh) {
+          edges[k++] = std::make_tuple(c_src, c_ngh, value_f(src, ngh));
+        }
+      };
+      GA.V[i].mapOutNgh(i, map_f, false);
+    });
+    deg_map.clear();
+
+    // Group by source cluster, then sort each group by target cluster.
+    pbbslib::integer_sort_inplace(
+        edges.slice(), [&](const T& e) { return std::get<0>(e); },
+        pbbslib::log2_up(num_clusters));
+    auto is_start = pbbs::delayed_seq<bool>(m, [&] (size_t i) {
+      return (i == 0) || (std::get<0>(edges[i]) != std::get<0>(edges[i - 1]));
+    });
+    auto starts = pbbslib::pack_index<size_t>(is_start);
+    auto ngh_lt = [&](const T& l, const T& r) {
+      return std::get<1>(l) < std::get<1>(r);
+    };
+    par_for(0, starts.size(), 1, [&] (size_t j) {
+      size_t s = starts[j];
+      size_t e = (j + 1 < starts.size()) ? starts[j + 1] : m;
+      if (e - s > kSeqSortThreshold) {
+        pbbslib::sample_sort_inplace(edges.slice(s, e), ngh_lt);
+      } else {
+        std::sort(edges.begin() + s, edges.begin() + e, ngh_lt);
+      }
+    });
+
+    // Keep the first edge of every run of equal cluster pairs.
+    auto is_first = pbbs::delayed_seq<bool>(m, [&] (size_t i) {
+      return (i == 0) || (std::get<0>(edges[i]) != std::get<0>(edges[i - 1])) ||
+             (std::get<1>(edges[i]) != std::get<1>(edges[i - 1]));
+    });
+    auto ret = pbbslib::pack(edges, is_first);
+    sort_t.stop();
+    debug(sort_t.reportTotal("sort time"););
+    debug(cout << "edges.size = " << ret.size() << endl);
+    return ret;
+  }
+
+}  // namespace contract_sort
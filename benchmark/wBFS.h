@@ -66,25 +66,48 @@ struct Visit_F {
   inline bool cond(const uintE& d) const { return true; }
 };
 
-}  // namespace wbfs
+// Visit_F for one side of a bidirectional search. Every scanned edge (s, d)
+// whose target has been labeled by the other side gives an s-t path of length
+// dists[s] + w + other[d], which is recorded in best.
+struct STVisit_F {
+  Visit_F visit;
+  sequence<uintE>& dists;
+  sequence<uintE>& other;
+  uintE* best;
+  STVisit_F(sequence<uintE>& _dists, sequence<uintE>& _other, uintE* _best)
+      : visit(_dists), dists(_dists), other(_other), best(_best) {}
 
-template <
-    template <typename W> class vertex, class W,
-    typename std::enable_if<std::is_same<W, int32_t>::value, int>::type = 0>
-inline sequence<uintE> wBFS(graph<vertex<W>>& G, uintE src,
-                              size_t num_buckets = 128, bool largemem = false,
-                              bool no_blocked = false) {
-  auto before_state = get_pcm_state();
-  timer t;
-  t.start();
+  inline void meet(const uintE& s, const uintE& d, const intE& w) {
+    uintE od = other[d];
+    if (od != INT_E_MAX) {
+      pbbslib::write_min(best, (dists[s] & VAL_MASK) + w + od);
+    }
+  }
 
-  timer init;
-  init.start();
-  size_t n = G.n;
+  inline Maybe<uintE> update(const uintE& s, const uintE& d, const intE& w) {
+    meet(s, d, w);
+    return visit.update(s, d, w);
+  }
 
-  auto dists = sequence<uintE>(n, [&](size_t i) { return INT_E_MAX; });
-  dists[src] = 0;
+  inline Maybe<uintE> updateAtomic(const uintE& s, const uintE& d,
+                                   const intE& w) {
+    meet(s, d, w);
+    return visit.updateAtomic(s, d, w);
+  }
+
+  inline bool cond(const uintE& d) const { return true; }
+};
 
+// Runs the bucketed search from every vertex whose distance in dists is not
+// INT_E_MAX. settle(bkt) is called with the identifiers of each bucket before
+// its vertices are visited; at that point their distances are final, assuming
+// positive edge weights. Returns the number of rounds.
+template <class G, class Settle>
+inline size_t bucketed_sssp(G& GA, sequence<uintE>& dists, size_t num_buckets,
+                            flags fl, Settle settle) {
+  timer init;
+  init.start();
+  size_t n = GA.n;
   auto get_bkt = [&](const uintE& dist) -> const uintE {
     return (dist == INT_E_MAX) ? UINT_E_MAX : dist;
   };
@@ -95,7 +118,7 @@ inline sequence<uintE> wBFS(graph<vertex<W>>& G, uintE src,
   auto b = make_vertex_buckets(n, get_ring, increasing, num_buckets);
 
   auto apply_f = [&](const uintE v, uintE& oldDist) -> void {
-    uintE newDist = dists[v] & wbfs::VAL_MASK;
+    uintE newDist = dists[v] & VAL_MASK;
     dists[v] = newDist;  // Remove the TOP_BIT in the distance.
     // Compute the previous bucket and new bucket for the vertex.
     uintE prev_bkt = get_bkt(oldDist), new_bkt = get_bkt(newDist);
@@ -108,16 +131,14 @@ inline sequence<uintE> wBFS(graph<vertex<W>>& G, uintE src,
   timer bt, emt;
   auto bkt = b.next_bucket();
   size_t rd = 0;
-  flags fl = dense_forward;
-  if (!largemem) fl |= no_dense;
-  if (!no_blocked) fl |= sparse_blocked;
   while (bkt.id != b.null_bkt) {
+    settle(bkt.identifiers);
     auto active = vertexSubset(n, bkt.identifiers);
     emt.start();
     // The output of the edgeMap is a vertexSubsetData<uintE> where the value
     // stored with each vertex is its original distance in this round
     auto res =
-        edgeMapData<uintE>(G, active, wbfs::Visit_F(dists), G.m / 20, fl);
+        edgeMapData<uintE>(GA, active, Visit_F(dists), GA.m / 20, fl);
     vertexMap(res, apply_f);
     // update buckets with vertices that just moved
     emt.stop();
@@ -133,8 +154,38 @@ inline sequence<uintE> wBFS(graph<vertex<W>>& G, uintE src,
     bt.stop();
     rd++;
   }
+  b.del();
   bt.reportTotal("bucket time");
   emt.reportTotal("edge map time");
+  return rd;
+}
+
+}  // namespace wbfs
+
+template <
+    template <typename W> class vertex, class W,
+    typename std::enable_if<std::is_same<W, int32_t>::value, int>::type = 0>
+inline sequence<uintE> wBFS(graph<vertex<W>>& G, uintE src,
+                              size_t num_buckets = 128, bool largemem = false,
+                              bool no_blocked = false,
+                              bool output_sens = false,
+                              bool transpose = false) {
+  auto before_state = get_pcm_state();
+  timer t;
+  t.start();
+
+  size_t n = G.n;
+  auto dists = sequence<uintE>(n, [&](size_t i) { return INT_E_MAX; });
+  dists[src] = 0;
+
+  flags fl = dense_forward;
+  if (!largemem) fl |= no_dense;
+  if (!no_blocked) fl |= sparse_blocked;
+  if (output_sens) fl |= output_sensitive;
+  // Distances to src instead of from src.
+  if (transpose) fl |= in_edges;
+  size_t rd = wbfs::bucketed_sssp(G, dists, num_buckets, fl,
+                                  [](sequence<uintE>& bkt) {});
   auto dist_f = [&](size_t i) { return (dists[i] == INT_E_MAX) ? 0 : dists[i]; };
   auto dist_im = pbbslib::make_sequence<size_t>(n, dist_f);
   std::cout << "max dist = " << pbbslib::reduce_max(dist_im) << "\n";
@@ -147,13 +198,150 @@ inline sequence<uintE> wBFS(graph<vertex<W>>& G, uintE src,
   return dists;
 }
 
+// Multi-source wBFS. Returns the distance from every vertex to its nearest
+// source, and the id of that source (UINT_E_MAX if no source reaches it),
+// i.e. a graph Voronoi partition around the sources. Ties are broken towards
+// the smaller source id. A vertex's label is computed when its bucket is
+// settled, as the smallest label of an in-neighbor on a shortest path to it,
+// which costs one more pass over the in-edges of the reached vertices.
+template <
+    template <typename W> class vertex, class W,
+    typename std::enable_if<std::is_same<W, int32_t>::value, int>::type = 0>
+inline std::tuple<sequence<uintE>, sequence<uintE>> wBFS_multi(
+    graph<vertex<W>>& G, sequence<uintE>& sources, size_t num_buckets = 128,
+    bool largemem = false) {
+  size_t n = G.n;
+  auto dists = sequence<uintE>(n, [&](size_t i) { return INT_E_MAX; });
+  auto nearest = sequence<uintE>(n, [&](size_t i) { return UINT_E_MAX; });
+  par_for(0, sources.size(), pbbslib::kSequentialForThreshold, [&] (size_t i) {
+    dists[sources[i]] = 0;
+    pbbslib::write_min(&nearest[sources[i]], sources[i]);
+  });
+
+  auto settle = [&](sequence<uintE>& bkt) {
+    par_for(0, bkt.size(), 1, [&] (size_t i) {
+      uintE v = bkt[i];
+      if (dists[v] == 0) return;
+      uintE d = dists[v];
+      auto map_f = [&](const uintE& v, const uintE& u, const W& w) -> uintE {
+        uintE du = dists[u];
+        return (du != INT_E_MAX && du + w == d) ? nearest[u] : UINT_E_MAX;
+      };
+      auto monoid = pbbslib::minm<uintE>();
+      nearest[v] = G.V[v].template reduceInNgh<uintE>(v, map_f, monoid);
+    });
+  };
+  flags fl = dense_forward | sparse_blocked;
+  if (!largemem) fl |= no_dense;
+  size_t rd = wbfs::bucketed_sssp(G, dists, num_buckets, fl, settle);
+  std::cout << "n rounds = " << rd << "\n";
+  return std::make_tuple(std::move(dists), std::move(nearest));
+}
+
+template <
+    template <typename W> class vertex, class W,
+    typename std::enable_if<!std::is_same<W, int32_t>::value, int>::type = 0>
+inline std::tuple<sequence<uintE>, sequence<uintE>> wBFS_multi(
+    graph<vertex<W>>& G, sequence<uintE>& sources, size_t num_buckets = 128,
+    bool largemem = false) {
+  assert(false);  // Unimplemented for unweighted graphs.
+  return std::make_tuple(sequence<uintE>(), sequence<uintE>());
+}
+
 template <
     template <typename W> class vertex, class W,
     typename std::enable_if<!std::is_same<W, int32_t>::value, int>::type = 0>
 inline sequence<uintE> wBFS(graph<vertex<W>>& G, uintE src,
                               size_t num_buckets = 128, bool largemem = false,
-                              bool no_blocked = false) {
+                              bool no_blocked = false,
+                              bool output_sens = false,
+                              bool transpose = false) {
   assert(false);  // Unimplemented for unweighted graphs; use a regular BFS.
   auto dists = sequence<uintE>(G.n, [&](size_t i) { return INT_E_MAX; });
   return dists;
 }
+
+// Computes the weighted distance from src to dst (INT_E_MAX if dst is not
+// reachable) with a bidirectional bucketed search. Each side keeps its own
+// bucket structure; every round processes the current bucket of the side
+// whose bucket is smaller, and the backward side follows in-edges. Once the
+// sum of the two current bucket ids is at least the best meeting distance
+// found so far, no shorter path can exist and the search stops.
+template <
+    template <typename W> class vertex, class W,
+    typename std::enable_if<std::is_same<W, int32_t>::value, int>::type = 0>
+inline uintE wBFS_st(graph<vertex<W>>& G, uintE src, uintE dst,
+                     size_t num_buckets = 128, bool largemem = false) {
+  size_t n = G.n;
+  if (src == dst) return 0;
+
+  auto dists_s = sequence<uintE>(n, [&](size_t i) { return INT_E_MAX; });
+  auto dists_t = sequence<uintE>(n, [&](size_t i) { return INT_E_MAX; });
+  dists_s[src] = 0;
+  dists_t[dst] = 0;
+  uintE best = INT_E_MAX;
+
+  auto get_bkt = [&](const uintE& dist) -> const uintE {
+    return (dist == INT_E_MAX) ? UINT_E_MAX : dist;
+  };
+  auto ring_s = pbbslib::make_sequence<uintE>(n, [&](const size_t& v) {
+    return get_bkt(dists_s[v]);
+  });
+  auto ring_t = pbbslib::make_sequence<uintE>(n, [&](const size_t& v) {
+    return get_bkt(dists_t[v]);
+  });
+  auto b_s = make_vertex_buckets(n, ring_s, increasing, num_buckets);
+  auto b_t = make_vertex_buckets(n, ring_t, increasing, num_buckets);
+
+  flags fl = dense_forward | sparse_blocked;
+  if (!largemem) fl |= no_dense;
+
+  // Processes bkt on one side and returns the next bucket of that side.
+  auto step = [&](auto& b, auto& bkt, sequence<uintE>& dists,
+                  sequence<uintE>& other, flags side_fl) {
+    auto apply_f = [&](const uintE v, uintE& oldDist) -> void {
+      uintE newDist = dists[v] & wbfs::VAL_MASK;
+      dists[v] = newDist;  // Remove the TOP_BIT in the distance.
+      uintE prev_bkt = get_bkt(oldDist), new_bkt = get_bkt(newDist);
+      oldDist = b.get_bucket(prev_bkt, new_bkt);
+    };
+    auto active = vertexSubset(n, bkt.identifiers);
+    auto res = edgeMapData<uintE>(
+        G, active, wbfs::STVisit_F(dists, other, &best), G.m / 20, side_fl);
+    vertexMap(res, apply_f);
+    if (res.dense()) {
+      b.update_buckets(res.get_fn_repr(), n);
+    } else {
+      b.update_buckets(res.get_fn_repr(), res.size());
+    }
+    res.del();
+    active.del();
+    return b.next_bucket();
+  };
+
+  auto bkt_s = b_s.next_bucket();
+  auto bkt_t = b_t.next_bucket();
+  size_t rd = 0;
+  while (bkt_s.id != b_s.null_bkt && bkt_t.id != b_t.null_bkt &&
+         bkt_s.id + bkt_t.id < best) {
+    if (bkt_s.identifiers.size() <= bkt_t.identifiers.size()) {
+      bkt_s = step(b_s, bkt_s, dists_s, dists_t, fl);
+    } else {
+      bkt_t = step(b_t, bkt_t, dists_t, dists_s, fl | in_edges);
+    }
+    rd++;
+  }
+  b_s.del();
+  b_t.del();
+  std::cout << "n rounds = " << rd << "\n";
+  return best;
+}
+
+template <
+    template <typename W> class vertex, class W,
+    typename std::enable_if<!std::is_same<W, int32_t>::value, int>::type = 0>
+inline uintE wBFS_st(graph<vertex<W>>& G, uintE src, uintE dst,
+                     size_t num_buckets = 128, bool largemem = false) {
+  assert(false);  // Unimplemented for unweighted graphs; use BFS_st.
+  return INT_E_MAX;
+}
@@ -39,6 +39,7 @@
 #include "bridge.h"
 #include "pbbs_strings.h"
 #include "graph.h"
+#include "encodings/byte_pd_amortized.h"
 
 
 typedef std::pair<uintE, uintE> intPair;
@@ -591,3 +592,66 @@ inline graph<vertex<W>> readCompressedSymmetricGraph(size_t n, size_t m,
 
   return G;
 }
+
+// Writes a symmetric graph, whose neighbor lists must be sorted, in the
+// bytepd-amortized format read by readCompressedGraph.
+template <template <typename W> class vertex, class W>
+inline void writeCompressedSymmetricGraph(graph<vertex<W>>& G,
+                                          const std::string& fname) {
+  size_t n = G.n;
+  auto degrees = sequence<uintE>(n);
+  auto byte_offsets = sequence<uintT>(n + 1);
+  par_for(0, n, 1, [&] (size_t i) {
+    size_t total_bytes = 0;
+    uintE last_ngh = 0;
+    size_t deg = 0;
+    uchar tmp[16];
+    auto f = [&](const uintE& u, const uintE& v, const W& w) {
+      long bytes = 0;
+      if ((deg % PARALLEL_DEGREE) == 0) {
+        bytes = bytepd_amortized::compressFirstEdge(tmp, bytes, u, v);
+      } else {
+        bytes = bytepd_amortized::compressEdge(tmp, bytes, v - last_ngh);
+      }
+      bytes = bytepd_amortized::compressWeight<W>(tmp, bytes, w);
+      last_ngh = v;
+      total_bytes += bytes;
+      deg++;
+    };
+    G.V[i].mapOutNgh(i, f, false);
+    if (deg > 0) {
+      size_t n_chunks = 1 + (deg - 1) / PARALLEL_DEGREE;
+      // block offsets, per-block counters and the virtual degree
+      total_bytes += (n_chunks - 1) * sizeof(uintE);
+      total_bytes += n_chunks * sizeof(uintE);
+      total_bytes += sizeof(uintE);
+    }
+    degrees[i] = deg;
+    byte_offsets[i] = total_bytes;
+  });
+  byte_offsets[n] = 0;
+  size_t total_space = pbbslib::scan_add_inplace(byte_offsets);
+
+  auto edges = sequence<uchar>(total_space);
+  par_for(0, n, 1, [&] (size_t i) {
+    uintE deg = degrees[i];
+    if (deg > 0) {
+      auto it = G.V[i].getOutIter(i);
+      long nbytes = bytepd_amortized::sequentialCompressEdgeSet<W>(
+          edges.begin() + byte_offsets[i], 0, deg, (uintE)i, it);
+      assert(nbytes == (long)(byte_offsets[i + 1] - byte_offsets[i]));
+    }
+  });
+
+  std::ofstream out(fname, std::ofstream::out | std::ios::binary);
+  if (!out.is_open()) {
+    std::cout << "Unable to open file " << fname << "\n";
+    abort();
+  }
+  long sizes[3] = {(long)n, (long)G.m, (long)total_space};
+  out.write((char*)sizes, sizeof(sizes));
+  out.write((char*)byte_offsets.begin(), sizeof(uintT) * (n + 1));
+  out.write((char*)degrees.begin(), sizeof(uintE) * n);
+  out.write((char*)edges.begin(), total_space);
+  out.close();
+}
@@ -233,6 +233,17 @@ namespace pbbslib {
     return pbbs::write_max<ET, F>(a, b, less);
   }
 
+  // Atomically ors b into *a and returns the previous value. Does not write
+  // if all bits of b are already set.
+  template <typename ET>
+  inline ET fetch_and_or(ET *a, ET b) {
+    ET oldv = *a;
+    while ((oldv | b) != oldv && !CAS(a, oldv, (ET)(oldv | b))) {
+      oldv = *a;
+    }
+    return oldv;
+  }
+
   // returns the log base 2 rounded up (works on ints or longs or unsigned versions)
   template <class T>
   inline size_t log2_up(T i) {
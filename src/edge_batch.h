@@ -0,0 +1,162 @@
+// This code is part of the project "Theoretically Efficient Parallel Graph
+// Algorithms Can Be Fast and Scalable", presented at Symposium on Parallelism
+// in Algorithms and Architectures, 2018.
+// Copyright (c) 2018 Laxman Dhulipala, Guy Blelloch, and Julian Shun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all  copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <tuple>
+
+#include "pbbslib/sparse_table.h"
+#include "graph.h"
+
+// Helpers for benchmarks that maintain a solution under batches of edge
+// updates on a symmetric, unweighted graph. A batch is a sequence of
+// undirected (u, v) pairs, each given once.
+namespace edge_batch {
+
+using pair = std::tuple<uintE, uintE>;
+
+inline size_t edge_key(uintE u, uintE v) {
+  size_t l = std::min(u, v);
+  size_t r = std::max(u, v);
+  return (l << 32) + r;
+}
+
+// Returns the distinct vertices of s. mark must be all false on entry, and
+// is all false again on return.
+template <class Seq>
+inline sequence<uintE> unique_vertices(Seq& s, bool* mark) {
+  auto fl = sequence<bool>(s.size(), [&](size_t i) {
+    return !mark[s[i]] && pbbslib::CAS(&mark[s[i]], false, true);
+  });
+  auto out = pbbslib::pack(s, fl);
+  par_for(0, out.size(), pbbslib::kSequentialForThreshold, [&] (size_t i)
+                  { mark[out[i]] = false; });
+  return out;
+}
+
+// Returns the distinct neighbors w of the vertices in vs with p(w) true.
+// Costs O(sum of the degrees of vs) work, plus the size of mark (see
+// unique_vertices).
+template <template <class W> class vertex, class W, class Seq, class P>
+inline sequence<uintE> neighbors(graph<vertex<W>>& G, Seq& vs, P& p,
+                                 bool* mark) {
+  auto offs = sequence<size_t>(vs.size() + 1, [&](size_t i) {
+    return (i == vs.size()) ? 0 : (size_t)G.V[vs[i]].getOutDegree();
+  });
+  size_t total = pbbslib::scan_add_inplace(offs.slice());
+  auto nghs = sequence<uintE>(total);
+  par_for(0, vs.size(), 1, [&] (size_t i) {
+    uintE v = vs[i];
+    size_t k = offs[i];
+    auto map_f = [&](const uintE& src, const uintE& ngh, const W& wgh) {
+      nghs[k++] = p(ngh) ? ngh : UINT_E_MAX;
+    };
+    G.V[v].mapOutNgh(v, map_f, false);
+  });
+  auto live = pbbslib::filter(nghs, [](uintE w) { return w != UINT_E_MAX; });
+  return unique_vertices(live, mark);
+}
+
+// Samples a batch of roughly batch_size / 2 existing edges (deletions) and
+// batch_size / 2 random vertex pairs (insertions). Self-loops are dropped.
+template <template <class W> class vertex, class W>
+inline std::tuple<sequence<pair>, sequence<pair>> random_batch(
+    graph<vertex<W>>& G, size_t batch_size, pbbslib::random r) {
+  size_t n = G.n;
+  size_t k = batch_size / 2;
+  auto del_all = sequence<pair>(k, [&](size_t i) {
+    uintE v = r.ith_rand(2 * i) % n;
+    uintE deg = G.V[v].getOutDegree();
+    if (deg == 0) return std::make_tuple(v, v);
+    uintE u = std::get<0>(
+        G.V[v].get_ith_out_neighbor(v, r.ith_rand(2 * i + 1) % deg));
+    return std::make_tuple(v, u);
+  });
+  auto ins_all = sequence<pair>(k, [&](size_t i) {
+    return std::make_tuple((uintE)(r.ith_rand(2 * (k + i)) % n),
+                           (uintE)(r.ith_rand(2 * (k + i) + 1) % n));
+  });
+  auto not_loop = [](const pair& e) {
+    return std::get<0>(e) != std::get<1>(e);
+  };
+  return std::make_tuple(pbbslib::filter(ins_all, not_loop),
+                         pbbslib::filter(del_all, not_loop));
+}
+
+// Returns a copy of the symmetric graph G with the edges in del removed and
+// the edges in ins added. Like sym_graph_from_edges, the result is
+// unweighted. Costs O(n + m) work; it is only used to materialize the
+// updated graph between batches.
+template <template <class W> class vertex, class W>
+inline graph<symmetricVertex<pbbslib::empty>> apply_batch(
+    graph<vertex<W>>& G, sequence<pair>& ins, sequence<pair>& del) {
+  using edge = std::tuple<uintE, uintE, pbbslib::empty>;
+  size_t n = G.n;
+  auto key_hash = [](const size_t& k) { return pbbslib::hash64(k); };
+  auto empty = std::make_tuple(std::numeric_limits<size_t>::max(),
+                               pbbslib::empty());
+  auto ins_t = make_sparse_table<size_t, pbbslib::empty>(ins.size() + 1,
+                                                         empty, key_hash);
+  auto del_t = make_sparse_table<size_t, pbbslib::empty>(del.size() + 1,
+                                                         empty, key_hash);
+  par_for(0, ins.size(), pbbslib::kSequentialForThreshold, [&] (size_t i) {
+    auto e = ins[i];
+    ins_t.insert(std::make_tuple(edge_key(std::get<0>(e), std::get<1>(e)),
+                                 pbbslib::empty()));
+  });
+  par_for(0, del.size(), pbbslib::kSequentialForThreshold, [&] (size_t i) {
+    auto e = del[i];
+    del_t.insert(std::make_tuple(edge_key(std::get<0>(e), std::get<1>(e)),
+                                 pbbslib::empty()));
+  });
+
+  // Existing copies of inserted edges are dropped too, so that the edges in
+  // ins are added exactly once.
+  auto pred = [&](const uintE& u, const uintE& v, const W& wgh) {
+    size_t key = edge_key(u, v);
+    return !del_t.contains(key) && !ins_t.contains(key);
+  };
+  auto kept = sample_edges(G, pred);
+  auto ins_keys = ins_t.entries();
+  size_t n_kept = kept.non_zeros;
+  size_t m = n_kept + 2 * ins_keys.size();
+  auto E = sequence<edge>(m, [&](size_t i) {
+    if (i < n_kept) {
+      auto e = kept.E[i];
+      return std::make_tuple(std::get<0>(e), std::get<1>(e), pbbslib::empty());
+    }
+    size_t key = std::get<0>(ins_keys[(i - n_kept) / 2]);
+    uintE l = key >> 32, r = key & UINT_MAX;
+    return ((i - n_kept) & 1) ? std::make_tuple(r, l, pbbslib::empty())
+                              : std::make_tuple(l, r, pbbslib::empty());
+  });
+  kept.del();
+  ins_t.del();
+  del_t.del();
+  auto A = edge_array<pbbslib::empty>(E.to_array(), n, n, m);
+  auto GB = sym_graph_from_edges(A);
+  A.del();
+  return GB;
+}
+
+}  // namespace edge_batch
@@ -32,6 +32,7 @@
 #include <type_traits>
 
 #include "pbbslib/binary_search.h"
+#include "pbbslib/dyn_arr.h"
 #include "pbbslib/utilities.h"
 #include "maybe.h"
 
@@ -136,6 +137,58 @@ inline auto get_emsparse_blocked_gen(std::tuple<uintE, data>* outEdges) {
   };
 }
 
+// Appends e to buf, growing it geometrically starting from kEMBufferMinSize.
+// Unlike dyn_arr::resize, the first allocation is small, so that many lightly
+// populated buffers stay proportional to their contents.
+template <class S>
+inline void em_buffer_push(pbbslib::dyn_arr<S>* buf, const S& e) {
+  if (buf->size == buf->capacity) {
+    size_t new_capacity = std::max(2 * buf->capacity, kEMBufferMinSize);
+    S* nA = pbbslib::new_array_no_init<S>(new_capacity);
+    for (size_t i = 0; i < buf->size; i++) {
+      nA[i] = buf->A[i];
+    }
+    if (buf->alloc) {
+      pbbslib::free_array(buf->A);
+    }
+    buf->A = nA;
+    buf->capacity = new_capacity;
+    buf->alloc = true;
+  }
+  buf->push_back(e);
+}
+
+// edgeMapBlockedOutputSensitive
+// Appends live neighbors to a growable buffer local to the current range
+// instead of writing to a preallocated offset; the offset is ignored.
+template <typename data,
+          typename std::enable_if<std::is_same<data, pbbslib::empty>::value,
+                                  int>::type = 0>
+inline auto get_emsparse_buffered_gen(
+    pbbslib::dyn_arr<std::tuple<uintE, data>>* buf) {
+  return [buf](uintE ngh, uintT offset, bool m = false) __attribute__((always_inline)) {
+    if (m) {
+      em_buffer_push(buf, std::make_tuple(ngh, pbbslib::empty()));
+      return true;
+    }
+    return false;
+  };
+}
+
+template <typename data,
+          typename std::enable_if<!std::is_same<data, pbbslib::empty>::value,
+                                  int>::type = 0>
+inline auto get_emsparse_buffered_gen(
+    pbbslib::dyn_arr<std::tuple<uintE, data>>* buf) {
+  return [buf](uintE ngh, uintT offset, Maybe<data> m = Maybe<data>()) __attribute__((always_inline)) {
+    if (m.exists) {
+      em_buffer_push(buf, std::make_tuple(ngh, m.t));
+      return true;
+    }
+    return false;
+  };
+}
+
 // Gen-functions that produce no output
 template <typename data,
           typename std::enable_if<std::is_same<data, pbbslib::empty>::value,
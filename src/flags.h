@@ -10,4 +10,7 @@ const flags remove_duplicates = 32;
 const flags no_dense = 64;
 const flags in_edges = 128;  // map over in edges instead of out edges
 const flags fine_parallel = 1 << 8; // split to a node-size of 1
+// sparse traversals use temporary space proportional to the output
+// rather than to the sum of frontier degrees
+const flags output_sensitive = 1 << 9;
 inline bool should_output(const flags& fl) { return !(fl & no_output); }
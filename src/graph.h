@@ -573,7 +573,7 @@ inline edge_array<W> sample_edges(graph<vertex<W>>& G, P& pred) {
 }
 
 // Mutates (sorts) the underlying array
-// Returns an unweighted, symmetric graph
+// Returns a symmetric graph with the weights of the edges
 template <class W>
 inline graph<symmetricVertex<W>> sym_graph_from_edges(edge_array<W>& A,
                                                       bool is_sorted = false) {
@@ -603,20 +603,24 @@ inline graph<symmetricVertex<W>> sym_graph_from_edges(edge_array<W>& A,
     pbbslib::integer_sort_inplace(Am, first, bits);
   }
 
-  auto starts = sequence<uintT>(n);
+  auto starts = sequence<uintT>(n, [](size_t i) { return 0; });
+  auto ends = sequence<uintT>(n, [](size_t i) { return 0; });
   V* v = pbbslib::new_array_no_init<V>(n);
-  auto edges = sequence<uintE>(m, [&](size_t i) {
+  auto edges = sequence<std::tuple<uintE, W>>(m, [&](size_t i) {
     // Fuse loops over edges (check if this helps)
     if (i == 0 || (std::get<0>(Am[i]) != std::get<0>(Am[i - 1]))) {
       starts[std::get<0>(Am[i])] = i;
     }
-    return std::get<1>(Am[i]);
+    if (i == m - 1 || (std::get<0>(Am[i]) != std::get<0>(Am[i + 1]))) {
+      ends[std::get<0>(Am[i])] = i + 1;
+    }
+    return std::make_tuple(std::get<1>(Am[i]), std::get<2>(Am[i]));
   });
+  // Vertices without edges keep starts[i] == ends[i] == 0.
   par_for(0, n, pbbslib::kSequentialForThreshold, [&] (size_t i) {
     uintT o = starts[i];
-    size_t degree = ((i == n - 1) ? m : starts[i + 1]) - o;
-    v[i].degree = degree;
-    v[i].neighbors = ((std::tuple<uintE, W>*)(edges.begin() + o));
+    v[i].degree = ends[i] - o;
+    v[i].neighbors = edges.begin() + o;
   });
   return graph<V>(v, n, m, get_deletion_fn(v, edges.to_array()));
 }
@@ -418,6 +418,118 @@ inline vertexSubsetData<data> edgeMapBlocked(graph<vertex>& GA,
 }
 #endif
 
+// Variant of edgeMapBlocked whose temporary space is proportional to the size
+// of the output rather than to the sum of the frontier degrees. The frontier
+// is decomposed exactly as in edgeMapBlocked, but each range appends its live
+// neighbors to its own growable buffer, which are then copied into the output.
+// Without AMORTIZEDPD, vertices cannot be split into blocks, so a range holds
+// whole vertices and a high-degree vertex is processed by a single thread.
+template <class data, class vertex, class VS, class F>
+inline vertexSubsetData<data> edgeMapBlockedOutputSensitive(
+    graph<vertex>& GA, vertex* frontier_vertices, VS& indices, uintT m, F& f,
+    const flags fl) {
+  if (fl & no_output) {
+    return edgeMapSparseNoOutput<data, vertex, VS, F>(GA, frontier_vertices,
+                                                      indices, m, f, fl);
+  }
+  using S = std::tuple<uintE, data>;
+  size_t n = indices.n;
+  auto degree_f = [&](size_t i) {
+    return (fl & in_edges) ? frontier_vertices[i].getInVirtualDegree()
+                           : frontier_vertices[i].getOutVirtualDegree();
+  };
+  auto degree_imap = pbbslib::make_sequence<uintE>(indices.size(), degree_f);
+
+#ifdef AMORTIZEDPD
+  // 1. Subdivide each vertex into blocks of <= kEMBlockSize edges and scan
+  // the block degrees.
+  auto vertex_offs = sequence<uintE>(indices.size() + 1);
+  par_for(0, indices.size(), pbbslib::kSequentialForThreshold, [&] (size_t i)
+      { vertex_offs[i] = (degree_imap[i] + kEMBlockSize - 1) / kEMBlockSize; });
+  vertex_offs[indices.size()] = 0;
+  size_t num_blocks = pbbslib::scan_add_inplace(vertex_offs);
+  auto blocks = sequence<block>(num_blocks);
+  auto degrees = sequence<uintT>(num_blocks);
+  par_for(0, indices.size(), pbbslib::kSequentialForThreshold, [&] (size_t i) {
+    size_t vtx_off = vertex_offs[i];
+    size_t num_blocks = vertex_offs[i + 1] - vtx_off;
+    size_t degree = degree_imap[i];
+    par_for(0, num_blocks, pbbslib::kSequentialForThreshold, [&] (size_t j) {
+      size_t block_deg =
+          std::min((j + 1) * kEMBlockSize, degree) - j * kEMBlockSize;
+      blocks[vtx_off + j] = block(i, j);
+      degrees[vtx_off + j] = block_deg;
+    });
+  });
+  vertex_offs.clear();
+#else
+  // 1. Scan the degrees of the frontier vertices.
+  size_t num_blocks = indices.size();
+  auto degrees = sequence<uintT>(num_blocks, [&](size_t i) {
+    return degree_imap[i];
+  });
+#endif
+  pbbslib::scan_add_inplace(degrees, pbbslib::fl_scan_inclusive);
+  size_t outEdgeCount = degrees[num_blocks - 1];
+
+  // 2. Compute the number of ranges, binary search for offsets.
+  size_t n_threads = pbbs::num_blocks(outEdgeCount, kEMBlockSize);
+  auto thread_offs = sequence<size_t>(n_threads + 1);
+  auto lt = [](const uintT& l, const uintT& r) { return l < r; };
+  par_for(0, n_threads, 1, [&] (size_t i) {
+    size_t start_off = i * kEMBlockSize;
+    thread_offs[i] = pbbslib::binary_search(degrees, start_off, lt);
+  });
+  thread_offs[n_threads] = num_blocks;
+
+  // 3. Process each range sequentially into its own buffer.
+  auto bufs = sequence<pbbslib::dyn_arr<S>>(n_threads);
+  auto cts = sequence<size_t>(n_threads + 1);
+  par_for(0, n_threads, 1, [&] (size_t i) {
+    size_t start = thread_offs[i];
+    size_t end = thread_offs[i + 1];
+    auto buf = pbbslib::dyn_arr<S>();
+    auto g = get_emsparse_buffered_gen<data>(&buf);
+    for (size_t j = start; j < end; j++) {
+#ifdef AMORTIZEDPD
+      uintE id = blocks[j].id;
+      uintE v = indices.vtx(id);
+      uintE b_size = (j == 0) ? degrees[j] : (degrees[j] - degrees[j - 1]);
+      uintE block_num = blocks[j].block_num;
+      (fl & in_edges) ? frontier_vertices[id].decodeInNghSparseBlock(
+                            v, 0, b_size, block_num, f, g)
+                      : frontier_vertices[id].decodeOutNghSparseBlock(
+                            v, 0, b_size, block_num, f, g);
+#else
+      uintE v = indices.vtx(j);
+      (fl & in_edges) ? frontier_vertices[j].decodeInNghSparseSeq(v, 0, f, g)
+                      : frontier_vertices[j].decodeOutNghSparseSeq(v, 0, f, g);
+#endif
+    }
+    bufs[i] = buf;
+    cts[i] = buf.size;
+  });
+  cts[n_threads] = 0;
+  size_t out_size = pbbslib::scan_add_inplace(cts);
+  degrees.clear();
+#ifdef AMORTIZEDPD
+  blocks.clear();
+#endif
+
+  // 4. Copy the buffers to the output.
+  S* out = pbbslib::new_array_no_init<S>(out_size);
+  par_for(0, n_threads, 1, [&] (size_t i) {
+    auto& buf = bufs[i];
+    size_t out_offset = cts[i];
+    for (size_t j = 0; j < buf.size; j++) {
+      out[out_offset + j] = buf.A[j];
+    }
+    buf.del();
+  });
+
+  return vertexSubsetData<data>(n, out_size, out);
+}
+
 // Decides on sparse or dense base on number of nonzeros in the active vertices.
 template <class data, class vertex, class VS, class F>
 inline vertexSubsetData<data> edgeMapData(graph<vertex>& GA, VS& vs, F f,
@@ -458,8 +570,12 @@ inline vertexSubsetData<data> edgeMapData(graph<vertex>& GA, VS& vs, F f,
   } else {
 //    auto vs_out = edgeMapSparse<data, vertex, VS, F>(GA, frontier_vertices, vs,
 //                                                      vs.numNonzeros(), f, fl);
-    auto vs_out = edgeMapBlocked<data, vertex, VS, F>(GA, frontier_vertices, vs,
-                                                      vs.numNonzeros(), f, fl);
+    auto vs_out =
+        (fl & output_sensitive)
+            ? edgeMapBlockedOutputSensitive<data, vertex, VS, F>(
+                  GA, frontier_vertices, vs, vs.numNonzeros(), f, fl)
+            : edgeMapBlocked<data, vertex, VS, F>(GA, frontier_vertices, vs,
+                                                  vs.numNonzeros(), f, fl);
     pbbslib::free_array(frontier_vertices);
     return vs_out;
   }
@@ -868,3 +984,55 @@ inline size_t get_pcm_state() { return (size_t)1; }
       }                                                                        \
     }                                                                          \
   }
+
+// Reads a weighted graph if -w is given, and an unweighted graph otherwise.
+#define generate_maybe_weighted_main(APP, mutates)                             \
+  int main(int argc, char* argv[]) {                                           \
+    commandLine P(argc, argv, " [-s] [-w] <inFile>");                          \
+    char* iFile = P.getArgument(0);                                            \
+    bool symmetric = P.getOptionValue("-s");                                   \
+    bool compressed = P.getOptionValue("-c");                                  \
+    bool weighted = P.getOptionValue("-w");                                    \
+    bool mmap = P.getOptionValue("-m");                                        \
+    bool mmapcopy = mutates;                                                   \
+    debug(std::cout << "mmapcopy = " << mmapcopy << "\n";);                    \
+    size_t rounds = P.getOptionLongValue("-rounds", 3);                        \
+    pcm_init();                                                                \
+    if (compressed) {                                                          \
+      if (symmetric && weighted) {                                             \
+        auto G = readCompressedGraph<csv_bytepd_amortized, intE>(              \
+            iFile, symmetric, mmap, mmapcopy);                                 \
+        run_app(G, APP, rounds)                                                \
+      } else if (symmetric) {                                                  \
+        auto G = readCompressedGraph<csv_bytepd_amortized, pbbslib::empty>(    \
+            iFile, symmetric, mmap, mmapcopy);                                 \
+        run_app(G, APP, rounds)                                                \
+      } else if (weighted) {                                                   \
+        auto G = readCompressedGraph<cav_bytepd_amortized, intE>(              \
+            iFile, symmetric, mmap, mmapcopy);                                 \
+        run_app(G, APP, rounds)                                                \
+      } else {                                                                 \
+        auto G = readCompressedGraph<cav_bytepd_amortized, pbbslib::empty>(    \
+            iFile, symmetric, mmap, mmapcopy);                                 \
+        run_app(G, APP, rounds)                                                \
+      }                                                                        \
+    } else {                                                                   \
+      if (symmetric && weighted) {                                             \
+        auto G =                                                               \
+            readWeightedGraph<symmetricVertex>(iFile, symmetric, mmap);        \
+        run_app(G, APP, rounds)                                                \
+      } else if (symmetric) {                                                  \
+        auto G =                                                               \
+            readUnweightedGraph<symmetricVertex>(iFile, symmetric, mmap);      \
+        run_app(G, APP, rounds)                                                \
+      } else if (weighted) {                                                   \
+        auto G =                                                               \
+            readWeightedGraph<asymmetricVertex>(iFile, symmetric, mmap);       \
+        run_app(G, APP, rounds)                                                \
+      } else {                                                                 \
+        auto G =                                                               \
+            readUnweightedGraph<asymmetricVertex>(iFile, symmetric, mmap);     \
+        run_app(G, APP, rounds)                                                \
+      }                                                                        \
+    }                                                                          \
+  }
@@ -70,6 +70,9 @@ typedef unsigned int uintE;
 
 // edgemap_sparse_blocked granularity macro
 constexpr const size_t kEMBlockSize = 4000;
+// initial capacity of the per-range buffers used by
+// edgeMapBlockedOutputSensitive
+constexpr const size_t kEMBufferMinSize = 16;
 
 // ======= compression macros and constants =======
 constexpr const size_t PARALLEL_DEGREE = 1000;
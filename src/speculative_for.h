@@ -53,16 +53,51 @@
     pbbslib::write_min<intT>(x, i);
   }
 
-  // granularity is some constant.
+  // Reusable round buffers and accumulated statistics for eff_for and
+  // speculative_for. Passing the same state to successive calls (e.g. one call
+  // per round of an outer loop) avoids reallocating the buffers, and the
+  // statistics accumulate over all of the calls.
+  template <class intT>
+  struct spec_for_state {
+    sequence<intT> I;
+    sequence<intT> Inext;
+    sequence<bool> keep;
+
+    size_t calls = 0;
+    size_t rounds = 0;
+    size_t attempts = 0;    // iterations tried, including failed tries
+    size_t iterations = 0;  // iterations that eventually succeeded
+
+    void ensure(size_t size) {
+      if (I.size() < size) {
+        I = sequence<intT>(size);
+        Inext = sequence<intT>(size);
+        keep = sequence<bool>(size);
+      }
+    }
+
+    void report() {
+      std::cout << "speculative_for: calls = " << calls
+                << " rounds = " << rounds << " attempts = " << attempts
+                << " iterations = " << iterations
+                << " wasted = " << (attempts - iterations) << "\n";
+    }
+  };
+
+  // Shared engine for eff_for and speculative_for. The round size starts at
+  // (e - s) / granularity + 1, doubles when less than 10% of a round fails and
+  // halves when more than 20% fails.
   template <class intT, class S>
-  inline intT eff_for(S step, intT s, intT e, intT granularity, bool hasState = 1,
-                      long maxTries = std::numeric_limits<long>::max()) {
+  inline intT spec_for_run(S& step, intT s, intT e, intT granularity,
+                           long maxTries, spec_for_state<intT>& st) {
     intT maxRoundSize = (e - s) / granularity + 1;
+    intT minRoundSize = maxRoundSize / 64 + 1;
     intT currentRoundSize = maxRoundSize;
 
-    auto I = sequence<intT>(maxRoundSize);
-    auto Inext = sequence<intT>(maxRoundSize);
-    auto keep = sequence<bool>(maxRoundSize);
+    st.ensure(maxRoundSize);
+    auto& I = st.I;
+    auto& Inext = st.Inext;
+    auto& keep = st.keep;
 
     intT round = 0;
     intT numberDone = s;      // number of iterations done
@@ -90,76 +125,48 @@
 
       // keep iterations that failed for next round. Written into Inext
       numberKeep = pbbslib::pack_out(I.slice(0, size), keep, Inext.slice());
-//      seq.set_allocated(false);
-//      numberKeep = seq.size();
       numberDone += size - numberKeep;
 
-      std::swap(I, Inext);
+      I.swap(Inext);
 
       // adjust round size based on number of failed attempts
-      if (float(numberKeep) / float(size) < .1) {
+      if (float(numberKeep) / float(size) > .2) {
+        currentRoundSize = std::max(currentRoundSize / 2,
+                                    std::max(minRoundSize, numberKeep));
+      } else if (float(numberKeep) / float(size) < .1) {
         currentRoundSize = std::min(currentRoundSize * 2, maxRoundSize);
       }
     }
+    st.calls++;
+    st.rounds += round;
+    st.attempts += totalProcessed;
+    st.iterations += (e - s);
     return totalProcessed;
   }
 
+  // granularity is some constant.
+  template <class intT, class S>
+  inline intT eff_for(S step, intT s, intT e, intT granularity, bool hasState = 1,
+                      long maxTries = std::numeric_limits<long>::max(),
+                      spec_for_state<intT>* st = nullptr) {
+    if (st != nullptr) {
+      return spec_for_run(step, s, e, granularity, maxTries, *st);
+    }
+    spec_for_state<intT> local;
+    return spec_for_run(step, s, e, granularity, maxTries, local);
+  }
+
   template <class intT, class S>
   inline intT speculative_for(S step, intT s, intT e, intT granularity,
-                              bool hasState = 1, long maxTries = -1) {
+                              bool hasState = 1, long maxTries = -1,
+                              spec_for_state<intT>* st = nullptr) {
     if (maxTries < 0) {
       maxTries = 100 + 200 * granularity;
     }
-    intT maxRoundSize = (e - s) / granularity + 1;
-    intT currentRoundSize = maxRoundSize;
-
-    auto I = sequence<intT>(maxRoundSize);
-    auto Inext = sequence<intT>(maxRoundSize);
-    auto keep = sequence<bool>(maxRoundSize);
-
-    intT round = 0;
-    intT numberDone = s;      // number of iterations done
-    intT numberKeep = 0;      // number of iterations to carry to next round
-    intT totalProcessed = 0;  // number done including wasted tries
-
-    while (numberDone < e) {
-      if (round++ > maxTries) {
-        std::cout << "speculative_for: too many iterations, increase maxTries"
-                  << "\n";
-        abort();
-      }
-
-      intT size = std::min(currentRoundSize, (intT)(e - numberDone));
-      totalProcessed += size;
-
-      par_for(0, size, [&] (size_t i) {
-        if (i >= numberKeep) I[i] = numberDone + i;
-        keep[i] = step.reserve(I[i]);
-      });
-
-      par_for(0, size, [&] (size_t i) {
-        if (keep[i]) keep[i] = !step.commit(I[i]);
-      });
-
-      // keep iterations that failed for next round. Written into Inext
-      numberKeep = pbbslib::pack_out(I.slice(0, size), keep, Inext.slice());
-//      numberKeep = pbbslib::pack_out(I.slice(0, size), keep, pbbslib::no_flag, Inext.slice());
-//      seq.set_allocated(false);
-//      numberKeep = seq.size();
-      numberDone += size - numberKeep;
-
-      std::swap(I, Inext);
-
-      // adjust round size based on number of failed attempts
-      if (float(numberKeep) / float(size) > .2)
-        currentRoundSize =
-            std::max(currentRoundSize / 2,
-                     std::max(maxRoundSize / 64 + 1, (intT)numberKeep));
-      else if (float(numberKeep) / float(size) < .1)
-        currentRoundSize = std::min(currentRoundSize * 2, maxRoundSize);
-      //    std::cout << size << " : " << numberKeep << " : " << numberDone <<
-      //    "\n";
+    if (st != nullptr) {
+      return spec_for_run(step, s, e, granularity, maxTries, *st);
     }
-    return totalProcessed;
+    spec_for_state<intT> local;
+    return spec_for_run(step, s, e, granularity, maxTries, local);
   }
 //}; // namespace pbbslib
@@ -57,6 +57,53 @@ struct UnionFind {
   void clear() { pbbslib::free_array(parents); }
 };
 
+// Concurrent union-find over a parents array in which a root r satisfies
+// parents[r] == r. Roots are always linked from the larger id to the smaller
+// one, so parents[i] only decreases and path compression can run
+// concurrently with links.
+namespace union_find {
+
+template <class intT>
+inline intT find_compress(intT i, intT* parents) {
+  intT j = i;
+  if (parents[j] == j) return j;
+  do {
+    j = parents[j];
+  } while (parents[j] != j);
+  intT tmp;
+  while ((tmp = parents[i]) > j) {
+    parents[i] = j;
+    i = tmp;
+  }
+  return j;
+}
+
+// Returns true iff this call linked the trees containing u and v, in which
+// case *linked is set to the root that was linked below the other. A root is
+// linked at most once, so at most one call reports it.
+template <class intT>
+inline bool unite_root(intT u, intT v, intT* parents, intT* linked) {
+  while (true) {
+    u = find_compress(u, parents);
+    v = find_compress(v, parents);
+    if (u == v) return false;
+    if (u < v) std::swap(u, v);
+    if (parents[u] == u && pbbslib::CAS(&parents[u], u, v)) {
+      *linked = u;
+      return true;
+    }
+  }
+}
+
+// Returns true iff this call linked the trees containing u and v.
+template <class intT>
+inline bool unite(intT u, intT v, intT* parents) {
+  intT linked;
+  return unite_root(u, v, parents, &linked);
+}
+
+}  // namespace union_find
+
 // edges: <uintE, uintE, W>
 template <class intT, class Edges, class ST, class UF>
 struct UnionFindStep {
@@ -306,8 +306,8 @@ template <template <typename W> class vertex, class W, class F>
 inline void mapNghs(vertex<W>* v, uintE vtx_id, std::tuple<uintE, W>* nghs,
                     uintE d, F& f, bool parallel) {
   par_for(0, d, pbbslib::kSequentialForThreshold, [&] (size_t j) {
-    uintE ngh = v->getOutNeighbor(j);
-    f(vtx_id, ngh, v->getOutWeight(j));
+    auto nw = nghs[j];
+    f(vtx_id, std::get<0>(nw), std::get<1>(nw));
   }, parallel);
 }
 
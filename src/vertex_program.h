@@ -0,0 +1,181 @@
+// This code is part of the project "Theoretically Efficient Parallel Graph
+// Algorithms Can Be Fast and Scalable", presented at Symposium on Parallelism
+// in Algorithms and Architectures, 2018.
+// Copyright (c) 2018 Laxman Dhulipala, Guy Blelloch, and Julian Shun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all  copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Gather-apply-scatter vertex programs. A program P supplies
+//   value_type                      : the type of gathered values
+//   monoid                          : a monoid over value_type
+//   gather(v, u, w) -> value_type   : the contribution of the edge (u, v)
+//   apply(v, value_type acc) -> bool: updates v with the reduced contributions
+//                                     and returns true if v is active next
+//   cond(v) -> bool                 : whether v may be updated this round
+// and step() runs one round: every vertex v with cond(v) and an in-neighbor u
+// in the frontier reduces gather(v, u, w) over its frontier in-neighbors,
+// applies the result, and the vertices whose apply returned true form the
+// next frontier. Passing in_edges in fl reverses the edge directions, and
+// no_output skips building the next frontier.
+//
+// The activation test is fused with the reduction: there is no separate pass
+// over the vertices to collect the next frontier. Rounds with a large frontier
+// pull over every vertex with edgeMapReduce_dense, and may then also call
+// apply(v, monoid.identity) for vertices without frontier in-neighbors, which
+// must leave v unchanged (and inactive) unless the frontier is every vertex.
+// Rounds with a small frontier collect the out-neighbors of the frontier and
+// run the reduction on just those vertices.
+
+#pragma once
+
+#include "edge_map_reduce.h"
+#include "ligra.h"
+
+namespace vertex_program {
+
+// Marks the out-neighbors of the frontier.
+struct Mark_F {
+  bool* marked;
+  Mark_F(bool* _marked) : marked(_marked) {}
+  template <class W>
+  inline bool update(const uintE& s, const uintE& d, const W& w) {
+    marked[d] = true;
+    return true;
+  }
+  template <class W>
+  inline bool updateAtomic(const uintE& s, const uintE& d, const W& w) {
+    return pbbslib::atomic_compare_and_swap(&marked[d], false, true);
+  }
+  inline bool cond(const uintE& d) { return !marked[d]; }
+};
+
+}  // namespace vertex_program
+
+template <class P, template <class W> class vertex, class W>
+struct VertexProgram {
+  using V = typename P::value_type;
+  using w_vertex = vertex<W>;
+  graph<w_vertex>& G;
+  P& prog;
+  flags fl;
+  size_t threshold;
+  EdgeMap<pbbs::empty, vertex, W> EM;
+  sequence<bool> marked;  // out-neighbors of a sparse frontier
+  sequence<bool> active;  // members of a sparse frontier
+  size_t num_dense, num_sparse;
+
+  VertexProgram(graph<w_vertex>& _G, P& _prog, flags _fl = 0,
+                size_t _threshold = 0)
+      : G(_G),
+        prog(_prog),
+        fl(_fl),
+        threshold(_threshold == 0 ? _G.m / 20 : _threshold),
+        EM(_G, std::make_tuple(UINT_E_MAX, pbbs::empty()), (size_t)1),
+        num_dense(0),
+        num_sparse(0) {
+    marked = sequence<bool>(G.n, false);
+    active = sequence<bool>(G.n, false);
+  }
+
+  inline V reduce_in(uintE v, const bool* in_frontier) {
+    auto map_f = [&](const uintE& d, const uintE& s, const W& w) -> V {
+      return in_frontier[s] ? prog.gather(d, s, w) : prog.monoid.identity;
+    };
+    return (fl & in_edges)
+               ? G.V[v].template reduceOutNgh<V>(v, map_f, prog.monoid)
+               : G.V[v].template reduceInNgh<V>(v, map_f, prog.monoid);
+  }
+
+  // Runs one round and returns the next frontier. The frontier is not freed.
+  vertexSubset step(vertexSubset& frontier) {
+    size_t n = G.n;
+    if (frontier.isEmpty()) return vertexSubset(n);
+    size_t out_degrees = 0;
+    if (frontier.size() < n) {
+      frontier.toSparse();
+      auto degree_f = [&](size_t i) -> size_t {
+        uintE v = frontier.vtx(i);
+        return (fl & in_edges) ? G.V[v].getInVirtualDegree()
+                               : G.V[v].getOutVirtualDegree();
+      };
+      auto degree_im =
+          pbbslib::make_sequence<size_t>(frontier.size(), degree_f);
+      out_degrees = pbbslib::reduce_add(degree_im);
+    }
+    if (frontier.size() == n || frontier.size() + out_degrees > threshold) {
+      return step_dense(frontier);
+    }
+    return step_sparse(frontier);
+  }
+
+  vertexSubset step_dense(vertexSubset& frontier) {
+    num_dense++;
+    size_t n = G.n;
+    bool all = (frontier.size() == n);
+    if (!all) frontier.toDense();
+    auto cond_f = [&](const uintE& v) { return prog.cond(v); };
+    auto map_f = [&](const uintE& d, const uintE& s, const W& w) -> V {
+      return (all || frontier.isIn(s)) ? prog.gather(d, s, w)
+                                       : prog.monoid.identity;
+    };
+    auto reduce_f = [&](const V& l, const V& r) { return prog.monoid.f(l, r); };
+    auto apply_f = [&](std::tuple<uintE, V> k) {
+      uintE v = std::get<0>(k);
+      if (prog.apply(v, std::get<1>(k))) {
+        return Maybe<std::tuple<uintE, pbbs::empty>>(
+            std::make_tuple(v, pbbs::empty()));
+      }
+      return Maybe<std::tuple<uintE, pbbs::empty>>();
+    };
+    return EM.template edgeMapReduce_dense<pbbs::empty, V>(
+        frontier, cond_f, map_f, reduce_f, apply_f, prog.monoid.identity,
+        fl ^ in_edges);
+  }
+
+  vertexSubset step_sparse(vertexSubset& frontier) {
+    num_sparse++;
+    size_t n = G.n;
+    vertexMap(frontier, [&](uintE v) { active[v] = true; });
+    auto cands = edgeMap(G, frontier, vertex_program::Mark_F(marked.begin()),
+                         -1, sparse_blocked | (fl & in_edges));
+    cands.toSparse();
+    auto activated = sequence<bool>(cands.size(), [&](size_t i) {
+      uintE v = cands.vtx(i);
+      marked[v] = false;
+      return prog.cond(v) && prog.apply(v, reduce_in(v, active.begin()));
+    });
+    vertexMap(frontier, [&](uintE v) { active[v] = false; });
+    if (fl & no_output) {
+      cands.del();
+      return vertexSubset(n);
+    }
+    auto cand_im = pbbslib::make_sequence<uintE>(
+        cands.size(), [&](size_t i) { return cands.vtx(i); });
+    auto out = pbbslib::pack(cand_im, activated);
+    size_t out_size = out.size();
+    cands.del();
+    return vertexSubset(n, out_size, out.to_array());
+  }
+};
+
+template <class P, template <class W> class vertex, class W>
+inline VertexProgram<P, vertex, W> make_vertex_program(graph<vertex<W>>& G,
+                                                       P& prog, flags fl = 0) {
+  return VertexProgram<P, vertex, W>(G, prog, fl);
+}